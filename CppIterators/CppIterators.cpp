@@ -73,6 +73,18 @@ int main() {
 		std::cout << v << " ";
 	}
 
+	std::cout << "\n\nRunning sum of FwdRange [0; 10) doubled, every other one:\n";
+	for (auto v : Iter::FwdRange(0, 10)
+		.Map([sum = 0](auto x) mutable { return sum += x; })
+		.Map([](auto x) { return x * 2; })
+		.Filter([odd = false](auto) mutable { return odd = !odd; })
+		.Filter([](auto x) { return x != 0; })) {
+		std::cout << v << " ";
+	}
+
+	std::cout << "\n\nDDRange [0; 10) numbered by a stateful Map: sum = "
+		<< Iter::DDRange(0, 10).Map([n = 0](auto x) mutable { return x * n++; }).Map([](auto x) { return x + 1; }).Sum() << "\n";
+
 	{
 		std::cout << "\n";
 		auto it = Iter::DDRange(0, 5);
@@ -94,4 +106,14 @@ int main() {
 			std::cout << v << " ";
 		}
 	}
+	{
+		std::cout << "\n\nIter::From(vec).Skip(999990).Reverse():\n";
+		std::vector<int> vec(1000000);
+		for (auto [i, v] : Iter::FromRef(vec).Enumerate()) {
+			v = int(i);
+		}
+		for (auto v : Iter::From(vec).Skip(999990).Reverse()) {
+			std::cout << v << " ";
+		}
+	}
 }
@@ -8,17 +8,52 @@ namespace Iter
 	 * struct {
 	 *     using Type = ...;
 	 *
-	 *     // true if Count() works
+	 *     // true if SizeHint() is always exact
 	 *     static inline constexpr bool FastCount = ...;
 	 *
-	 *     // return length of the iterator with O(1) complexity if possible
-	 *     size_t Count()             { ... }
+	 *     // return bounds of the remaining length with O(1) complexity
+	 *     SizeBounds SizeHint()      { ... }
 	 *
-	 *     // return front and move forward
-	 *     std::optional<Type> Next() { ... }
+	 *     // return front and move forward, Type may be a reference to pass items on without copying
+	 *     Option<Type> Next() { ... }
 	 * 
 	 * 	   // return back and move backwards
-	 *     std::optional<Type> NextBack() { ... }
+	 *     Option<Type> NextBack() { ... }
+	 *
+	 *     // optional: skip up to n items from the front with O(1) complexity, return number of skipped items
+	 *     size_t Advance(size_t n)       { ... }
+	 *
+	 *     // optional: skip up to n items from the back with O(1) complexity, return number of skipped items
+	 *     size_t AdvanceBack(size_t n)   { ... }
+	 *
+	 *     // optional: view of the remaining items if they are stored contiguously in memory
+	 *     Slice<const Type> AsSlice() { ... }
+	 *
+	 *     // optional: the remaining items as an arithmetic progression, lets Sum, Min, Max and Product skip iterating
+	 *     Progression<Type> AsProgression() { ... }
+	 *
+	 *     // optional: the items NextBack() would return as an arithmetic progression
+	 *     Progression<Type> AsProgressionBack() { ... }
+	 *
+	 *     // optional: write up to n items to out, return the number of written items,
+	 *     // less than n only if the iterator was exhausted
+	 *     size_t NextBatch(ValueOf<Type>* out, size_t n) { ... }
+	 *
+	 *     // optional: keep the first n items, return the rest as a separate trait
+	 *     DDTrait SplitAt(size_t n) { ... }
+	 *
+	 *     // optional: keep the front part, return the back part as an independent trait,
+	 *     // nullopt if the remaining items can't be split any further
+	 *     std::optional<DDTrait> Split() { ... }
+	 *
+	 *     // optional: call func(acc, item) for each item until it returns false,
+	 *     // return true if the iterator was exhausted
+	 *     template<class Acc, class Func>
+	 *     bool TryFold(Acc& acc, Func&& func) { ... }
+	 *
+	 *     // optional: same as TryFold, but from the back
+	 *     template<class Acc, class Func>
+	 *     bool TryRFold(Acc& acc, Func&& func) { ... }
 	 * };
 	*/
 	template<class DDTrait>
@@ -28,45 +63,155 @@ namespace Iter
 	public:
 		using Type = typename DDTrait::Type;
 		static inline constexpr bool FastCount = DDTrait::FastCount;
+		static inline constexpr bool FastAdvance = HasAdvance<DDTrait>::value;
+		static inline constexpr bool FastAdvanceBack = HasAdvanceBack<DDTrait>::value;
+		static inline constexpr bool FastSplit = HasSplit<DDTrait>::value;
+		static inline constexpr bool FastBatch = HasNextBatch<DDTrait>::value;
 
-		constexpr inline DDIterator(DDTrait t) : m_trait(t) { }
+		constexpr inline DDIterator(DDTrait t) : m_trait(std::move(t)) { }
 
-		inline constexpr std::optional<Type> Next() noexcept {
+		inline constexpr Option<Type> Next() noexcept {
 			return m_trait.Next();
 		}
 
-		inline constexpr std::optional<Type> NextBack() noexcept {
+		inline constexpr Option<Type> NextBack() noexcept {
 			return m_trait.NextBack();
 		}
 
-		inline auto begin() const noexcept {
+		// write up to n items to out, return the number of written items, less than n only if the iterator was exhausted
+		inline constexpr size_t NextBatch(ValueOf<Type>* out, size_t n) {
+			if constexpr (HasNextBatch<DDTrait>::value) {
+				return m_trait.NextBatch(out, n);
+			}
+			size_t i = 0;
+			if (n == 0)
+				return i;
+			TryFold(i, [out, n](size_t& i, auto&& v) {
+				out[i++] = std::forward<decltype(v)>(v);
+				return i < n;
+			});
+			return i;
+		}
+
+		inline constexpr size_t Advance(size_t n) noexcept {
+			if constexpr (HasAdvance<DDTrait>::value) {
+				return m_trait.Advance(n);
+			}
+			size_t i = 0;
+			while (i < n && m_trait.Next())
+				++i;
+			return i;
+		}
+
+		inline constexpr size_t AdvanceBack(size_t n) noexcept {
+			if constexpr (HasAdvanceBack<DDTrait>::value) {
+				return m_trait.AdvanceBack(n);
+			}
+			size_t i = 0;
+			while (i < n && m_trait.NextBack())
+				++i;
+			return i;
+		}
+
+		// call func(acc, item) for each item until it returns false, return true if all items were visited
+		template<class Acc, class Func>
+		inline constexpr bool TryFold(Acc& acc, Func&& func) noexcept {
+			if constexpr (HasTryFold<DDTrait>::value) {
+				return m_trait.TryFold(acc, func);
+			}
+			while (auto v = m_trait.Next()) {
+				if (!func(acc, std::forward<Type>(*v)))
+					return false;
+			}
+			return true;
+		}
+
+		// same as TryFold, but from the back
+		template<class Acc, class Func>
+		inline constexpr bool TryRFold(Acc& acc, Func&& func) noexcept {
+			if constexpr (HasTryRFold<DDTrait>::value) {
+				return m_trait.TryRFold(acc, func);
+			}
+			while (auto v = m_trait.NextBack()) {
+				if (!func(acc, std::forward<Type>(*v)))
+					return false;
+			}
+			return true;
+		}
+
+		// state of the adapter, lets Map, Filter and Take look into their upstream to fuse with it
+		inline constexpr const DDTrait& GetTrait() const noexcept {
+			return m_trait;
+		}
+
+		template<class U = DDTrait, std::enable_if_t<HasAsSlice<U>::value, int> = 0>
+		inline constexpr auto AsSlice() const noexcept {
+			return m_trait.AsSlice();
+		}
+
+		template<class U = DDTrait, std::enable_if_t<HasAsProgression<U>::value, int> = 0>
+		inline constexpr auto AsProgression() const noexcept {
+			return m_trait.AsProgression();
+		}
+
+		template<class U = DDTrait, std::enable_if_t<HasAsProgressionBack<U>::value, int> = 0>
+		inline constexpr auto AsProgressionBack() const noexcept {
+			return m_trait.AsProgressionBack();
+		}
+
+		// cut off the back part into an independent iterator, nullopt if it can't be split any further
+		template<class U = DDTrait, std::enable_if_t<HasSplit<U>::value, int> = 0>
+		inline constexpr std::optional<DDIterator> Split() {
+			if (auto rest = m_trait.Split())
+				return DDIterator(*rest);
+			return {};
+		}
+
+		// keep the first n items, return an iterator over the rest
+		template<class U = DDTrait, std::enable_if_t<HasSplitAt<U>::value, int> = 0>
+		inline constexpr DDIterator SplitAt(size_t n) {
+			return DDIterator(m_trait.SplitAt(n));
+		}
+
+		inline constexpr auto begin() const noexcept {
 			return RangeForIter<DDIterator<DDTrait>>(*this);
 		}
 
-		inline auto end() const noexcept {
-			return RangeForIter<DDIterator<DDTrait>>(*this, false);
+		inline constexpr RangeForEnd end() const noexcept {
+			return {};
 		}
 
 		inline constexpr auto Skip(size_t n) const noexcept;
 		inline constexpr auto Take(size_t n) const noexcept;
 		inline constexpr auto StepBy(size_t n) const noexcept;
-		inline constexpr std::optional<Type> Nth(size_t n) const noexcept;
+
+		// Slice views of n items at a time, the last one may be shorter, n = 0 is taken as 1, see DDChunksIterTrait
+		inline constexpr auto Chunks(size_t n) const;
+
+		// same as Chunks, the items at the end that don't fill a whole chunk are dropped
+		inline constexpr auto ChunksExact(size_t n) const;
+
+		// Slice views of every n consecutive items, see DDWindowsIterTrait
+		inline constexpr auto Windows(size_t n) const;
+
+		inline constexpr Option<Type> Nth(size_t n) const noexcept;
 
 		template<class Iter>
 		inline constexpr auto Zip(Iter other) const noexcept;
 		template<class Iter>
 		inline constexpr auto Chain(Iter other) const noexcept;
 
-		inline constexpr auto Enumerate() const noexcept;
+		inline constexpr auto Enumerate(size_t start = 0) const noexcept;
 
 		inline constexpr auto Reverse() const noexcept;
 
 		template<class Func, class Ret>
 		inline constexpr Ret Fold(Ret init, Func func) const noexcept {
 			auto it = *this;
-			while (auto v = it.Next()) {
-				init = func(init, v.value());
-			}
+			it.TryFold(init, [&func](Ret& acc, auto&& v) {
+				acc = func(std::move(acc), std::forward<decltype(v)>(v));
+				return true;
+			});
 			return init;
 		}
 
@@ -74,16 +219,33 @@ namespace Iter
 		inline constexpr auto Fold(Func func) const noexcept {
 			auto it = *this;
 			auto init = it.Next().value();
-			while (auto v = it.Next()) {
-				init = func(init, v.value());
-			}
+			it.TryFold(init, [&func](auto& acc, auto&& v) {
+				acc = func(std::move(acc), std::forward<decltype(v)>(v));
+				return true;
+			});
 			return init;
 		}
 
+		template<class Func>
+		inline constexpr void ForEach(Func func) const noexcept {
+			auto it = *this;
+			bool dummy = true;
+			it.TryFold(dummy, [&func](bool&, auto&& v) {
+				func(std::forward<decltype(v)>(v));
+				return true;
+			});
+		}
+
+		inline constexpr SizeBounds SizeHint() const noexcept {
+			return m_trait.SizeHint();
+		}
+
 		inline constexpr size_t Count() const noexcept {
 			if constexpr (DDTrait::FastCount) {
-				return m_trait.Count();
+				return m_trait.SizeHint().lower;
 			}
+			if (auto hint = m_trait.SizeHint(); hint.IsExact())
+				return hint.lower;
 			return Fold(size_t(0),
 				[](auto a, auto) {
 					return a + 1;
@@ -92,31 +254,163 @@ namespace Iter
 		}
 
 		inline constexpr auto Sum() const noexcept {
+			if constexpr (HasAsProgression<DDTrait>::value) {
+				return m_trait.AsProgression().Sum();
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Sum> && HasAsSlice<DDTrait>::value) {
+				auto slice = m_trait.AsSlice();
+				return Simd::Reduce<Simd::Reduction::Sum>(slice.data(), slice.size(), Type(0));
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Sum> && HasNextBatch<DDTrait>::value) {
+				return BatchReduceImpl<Simd::Reduction::Sum>(*this).value_or(Type(0));
+			}
 			return Fold([](auto a, auto b) { return a + b; });
 		}
 
 		inline constexpr auto Product() const noexcept {
+			if constexpr (HasAsProgression<DDTrait>::value) {
+				if (auto res = m_trait.AsProgression().Product())
+					return *res;
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Product> && HasAsSlice<DDTrait>::value) {
+				auto slice = m_trait.AsSlice();
+				return Simd::Reduce<Simd::Reduction::Product>(slice.data(), slice.size(), Type(1));
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Product> && HasNextBatch<DDTrait>::value) {
+				return BatchReduceImpl<Simd::Reduction::Product>(*this).value_or(Type(1));
+			}
 			return Fold([](auto a, auto b) { return a * b; });
 		}
 
+		inline constexpr Option<Type> Min() const noexcept {
+			if constexpr (HasAsProgression<DDTrait>::value) {
+				auto prog = m_trait.AsProgression();
+				if (prog.count == 0)
+					return {};
+				return prog.Min();
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Min> && HasAsSlice<DDTrait>::value) {
+				auto slice = m_trait.AsSlice();
+				if (slice.empty())
+					return {};
+				return Simd::Reduce<Simd::Reduction::Min>(slice.data(), slice.size(), slice[0]);
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Min> && HasNextBatch<DDTrait>::value) {
+				return BatchReduceImpl<Simd::Reduction::Min>(*this);
+			}
+			auto it = *this;
+			auto res = it.Next();
+			if (res) {
+				it.TryFold(res, [](Option<Type>& acc, auto&& v) {
+					if (v < *acc)
+						acc.emplace(std::forward<decltype(v)>(v));
+					return true;
+				});
+			}
+			return res;
+		}
+
+		inline constexpr Option<Type> Max() const noexcept {
+			if constexpr (HasAsProgression<DDTrait>::value) {
+				auto prog = m_trait.AsProgression();
+				if (prog.count == 0)
+					return {};
+				return prog.Max();
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Max> && HasAsSlice<DDTrait>::value) {
+				auto slice = m_trait.AsSlice();
+				if (slice.empty())
+					return {};
+				return Simd::Reduce<Simd::Reduction::Max>(slice.data(), slice.size(), slice[0]);
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Max> && HasNextBatch<DDTrait>::value) {
+				return BatchReduceImpl<Simd::Reduction::Max>(*this);
+			}
+			auto it = *this;
+			auto res = it.Next();
+			if (res) {
+				it.TryFold(res, [](Option<Type>& acc, auto&& v) {
+					if (*acc < v)
+						acc.emplace(std::forward<decltype(v)>(v));
+					return true;
+				});
+			}
+			return res;
+		}
+
 		template<class Func>
 		inline constexpr auto Map(Func func) const noexcept;
 
+		// parallel view, see ParIterator
+		inline auto Par(size_t minChunk = 1) const noexcept;
+
+		// parallel view for sources that can only be read in order, see ParBridge
+		inline auto ParBridge(size_t batch = 1024) const noexcept;
+
+		// aggregates of every w consecutive items, single pass with O(1) per item, see RollingIterTrait
+		inline auto RollingSum(size_t w) const;
+		inline auto RollingMean(size_t w) const;
+		inline auto RollingMin(size_t w) const;
+		inline auto RollingMax(size_t w) const;
+
+		// run this iterator on a background thread that stays up to n items ahead, see PrefetchState
+		inline auto Prefetch(size_t n = 1024) const;
+		// end a pipeline stage: the adapters since the previous Stage() run on a thread of their own,
+		// connected to the next stage by a queue of n items, see Stages()
+		inline auto Stage(size_t n = 1024) const;
+
 		template<class Func>
 		inline constexpr auto Filter(Func func) const noexcept;
 
 		template<class Cont>
 		inline constexpr auto Collect() const noexcept {
-			auto it = *this;
 			Cont cont{};
-			while (auto v = it.Next()) {
-				cont.push_back(v.value());
-			}
+			CollectImpl(*this, cont);
+			return cont;
+		}
+
+		template<class Cont>
+		inline auto Collect(const typename Cont::allocator_type& alloc) const noexcept {
+			Cont cont(alloc);
+			CollectImpl(*this, cont);
 			return cont;
 		}
 
+		// write up to size items to data, return number of written items
+		template<class Out>
+		inline constexpr size_t CollectInto(Out* data, size_t size) const noexcept {
+			return CollectIntoImpl(*this, data, size);
+		}
+
+		// write items to an array, vector, span etc. without resizing it
+		template<class Out>
+		inline constexpr size_t CollectInto(Out&& out) const noexcept {
+			return CollectIntoImpl(*this, std::data(out), std::size(out));
+		}
+
+		// return first N items, empty if there are less than N
+		template<size_t N>
+		inline constexpr std::optional<std::array<ValueOf<Type>, N>> ToArray() const noexcept {
+			std::array<ValueOf<Type>, N> arr{};
+			if (CollectInto(arr) < N)
+				return {};
+			return arr;
+		}
+
 		inline constexpr auto ToVector() const noexcept {
-			return Collect<std::vector<Type>>();
+			return Collect<std::vector<ValueOf<Type>>>();
+		}
+
+		inline auto ToVector(std::pmr::memory_resource* resource) const noexcept {
+			return Collect<std::pmr::vector<ValueOf<Type>>>(resource);
+		}
+
+		inline constexpr auto ToList() const noexcept {
+			return Collect<std::list<ValueOf<Type>>>();
+		}
+
+		inline auto ToList(std::pmr::memory_resource* resource) const noexcept {
+			return Collect<std::pmr::list<ValueOf<Type>>>(resource);
 		}
 	};
 
@@ -127,24 +421,89 @@ namespace Iter
 		using Type = T;
 		static inline constexpr bool FastCount = true;
 
-		constexpr inline size_t Count() const noexcept {
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return SizeBounds::Exact(Length());
+		}
+
+		constexpr inline size_t Length() const noexcept {
 			return size_t(end) - size_t(begin);
 		}
 
 		constexpr inline DoubleDirRangeIterTrait(T b, T e)
 			: begin(b), end(e) { }
 
-		constexpr inline std::optional<T> Next() {
+		constexpr inline Progression<T> AsProgression() const noexcept {
+			return { begin, 1, Length() };
+		}
+
+		constexpr inline Progression<T> AsProgressionBack() const noexcept {
+			return AsProgression().Reverse();
+		}
+
+		constexpr inline Option<T> Next() {
 			if (begin == end)
 				return {};
 			return begin++;
 		}
 
-		constexpr inline std::optional<T> NextBack() {
+		constexpr inline Option<T> NextBack() {
 			if (begin == end)
 				return {};
 			return --end;
 		}
+
+		constexpr inline size_t NextBatch(T* out, size_t n) noexcept {
+			n = std::min(n, Length());
+			for (size_t i = 0; i < n; ++i)
+				out[i] = T(begin + T(i));
+			begin += T(n);
+			return n;
+		}
+
+		constexpr inline size_t Advance(size_t n) noexcept {
+			n = std::min(n, Length());
+			begin += T(n);
+			return n;
+		}
+
+		constexpr inline size_t AdvanceBack(size_t n) noexcept {
+			n = std::min(n, Length());
+			end -= T(n);
+			return n;
+		}
+
+		// keep the first n items, return the rest
+		constexpr inline DoubleDirRangeIterTrait SplitAt(size_t n) noexcept {
+			n = std::min(n, Length());
+			auto rest = *this;
+			rest.begin = T(begin + T(n));
+			end = rest.begin;
+			return rest;
+		}
+
+		constexpr inline std::optional<DoubleDirRangeIterTrait> Split() noexcept {
+			if (Length() < 2)
+				return {};
+			return SplitAt(Length() / 2);
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			while (begin != end) {
+				if (!func(acc, begin++))
+					return false;
+			}
+			return true;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryRFold(Acc& acc, Func&& func) {
+			while (begin != end) {
+				if (!func(acc, --end))
+					return false;
+			}
+			return true;
+		}
 	};
 
 	template<class T1, class T2>
@@ -155,20 +514,448 @@ namespace Iter
 		return DDIterator(trait);
 	}
 
+	// items first, first + step, ... of a progression with any step
+	template<class T>
+	struct StepRangeIterTrait
+	{
+		Progression<T> prog;
+		using Type = T;
+		static inline constexpr bool FastCount = true;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return SizeBounds::Exact(prog.count);
+		}
+
+		constexpr inline StepRangeIterTrait(Progression<T> p) : prog(p) { }
+
+		constexpr inline Progression<T> AsProgression() const noexcept {
+			return prog;
+		}
+
+		constexpr inline Progression<T> AsProgressionBack() const noexcept {
+			return prog.Reverse();
+		}
+
+		constexpr inline Option<T> Next() {
+			if (prog.count == 0)
+				return {};
+			T v = prog.first;
+			prog = prog.Skip(1);
+			return v;
+		}
+
+		constexpr inline Option<T> NextBack() {
+			if (prog.count == 0)
+				return {};
+			return prog.At(--prog.count);
+		}
+
+		constexpr inline size_t NextBatch(T* out, size_t n) noexcept {
+			n = std::min(n, prog.count);
+			for (size_t i = 0; i < n; ++i)
+				out[i] = prog.At(i);
+			prog = prog.Skip(n);
+			return n;
+		}
+
+		constexpr inline size_t Advance(size_t n) noexcept {
+			n = std::min(n, prog.count);
+			prog = prog.Skip(n);
+			return n;
+		}
+
+		constexpr inline size_t AdvanceBack(size_t n) noexcept {
+			n = std::min(n, prog.count);
+			prog.count -= n;
+			return n;
+		}
+
+		// keep the first n items, return the rest
+		constexpr inline StepRangeIterTrait SplitAt(size_t n) noexcept {
+			auto rest = StepRangeIterTrait(prog.Skip(n));
+			prog = prog.Take(n);
+			return rest;
+		}
+
+		constexpr inline std::optional<StepRangeIterTrait> Split() noexcept {
+			if (prog.count < 2)
+				return {};
+			return SplitAt(prog.count / 2);
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			while (prog.count != 0) {
+				T v = prog.first;
+				prog = prog.Skip(1);
+				if (!func(acc, v))
+					return false;
+			}
+			return true;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryRFold(Acc& acc, Func&& func) {
+			while (prog.count != 0) {
+				if (!func(acc, prog.At(--prog.count)))
+					return false;
+			}
+			return true;
+		}
+	};
+
+	// floating point items start + i * step for i in [begin; end), the item at index last is exactly stop
+	template<class T>
+	struct LinearIterTrait
+	{
+		T start, step, stop;
+		size_t begin, end, last;
+		using Type = T;
+		static inline constexpr bool FastCount = true;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return SizeBounds::Exact(Length());
+		}
+
+		constexpr inline size_t Length() const noexcept {
+			return end - begin;
+		}
+
+		constexpr inline T At(size_t i) const noexcept {
+			return i == last ? stop : start + step * T(i);
+		}
+
+		constexpr inline Option<T> Next() {
+			if (begin == end)
+				return {};
+			return At(begin++);
+		}
+
+		constexpr inline Option<T> NextBack() {
+			if (begin == end)
+				return {};
+			return At(--end);
+		}
+
+		constexpr inline size_t NextBatch(T* out, size_t n) noexcept {
+			n = std::min(n, Length());
+			for (size_t i = 0; i < n; ++i)
+				out[i] = At(begin + i);
+			begin += n;
+			return n;
+		}
+
+		constexpr inline size_t Advance(size_t n) noexcept {
+			n = std::min(n, Length());
+			begin += n;
+			return n;
+		}
+
+		constexpr inline size_t AdvanceBack(size_t n) noexcept {
+			n = std::min(n, Length());
+			end -= n;
+			return n;
+		}
+
+		// keep the first n items, return the rest
+		constexpr inline LinearIterTrait SplitAt(size_t n) noexcept {
+			n = std::min(n, Length());
+			auto rest = *this;
+			rest.begin = begin + n;
+			end = rest.begin;
+			return rest;
+		}
+
+		constexpr inline std::optional<LinearIterTrait> Split() noexcept {
+			if (Length() < 2)
+				return {};
+			return SplitAt(Length() / 2);
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			while (begin != end) {
+				if (!func(acc, At(begin++)))
+					return false;
+			}
+			return true;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryRFold(Acc& acc, Func&& func) {
+			while (begin != end) {
+				if (!func(acc, At(--end)))
+					return false;
+			}
+			return true;
+		}
+	};
+
+	// items begin, begin + step, ... up to but excluding end, empty if step is 0 or points away from end
+	template<class T1, class T2, class S>
+	constexpr inline auto Range(T1 begin, T2 end, S step) {
+		static_assert(std::is_convertible<T2, T1>::value);
+		static_assert(std::is_arithmetic<T1>::value && std::is_arithmetic<S>::value);
+		if constexpr (std::is_floating_point_v<T1>) {
+			T1 len = (T1(end) - begin) / T1(step);
+			// NaN compares false, so a NaN length gives an empty range
+			size_t count = len > 0 ? size_t(-1) : 0;
+			if (len > 0 && len < T1(size_t(-1)))
+				count = size_t(std::ceil(len));
+			return DDIterator(LinearIterTrait<T1>{ begin, T1(step), begin, 0, count, size_t(-1) });
+		}
+		else {
+			static_assert(std::is_integral<S>::value);
+			uint64_t dist = step > 0 ? uint64_t(T1(end)) - uint64_t(begin) : uint64_t(begin) - uint64_t(T1(end));
+			uint64_t stride = step > 0 ? uint64_t(step) : uint64_t(0) - uint64_t(step);
+			size_t count = 0;
+			if (step != 0 && (step > 0 ? begin < T1(end) : T1(end) < begin))
+				count = size_t(dist / stride + (dist % stride != 0));
+			return DDIterator(StepRangeIterTrait<T1>(Progression<T1>{ begin, uint64_t(step), count }));
+		}
+	}
+
+	template<class T1, class T2>
+	constexpr inline auto Range(T1 begin, T2 end) {
+		if constexpr (std::is_floating_point_v<T1>) {
+			return Range(begin, end, T1(1));
+		}
+		else {
+			return DDRange(begin, end);
+		}
+	}
+
+	// runs up to the largest value of T
+	template<class T>
+	constexpr inline auto Range(T begin) {
+		return Range(begin, std::numeric_limits<T>::max());
+	}
+
+	// n evenly spaced items from begin to end, both included
+	template<class T>
+	constexpr inline auto Linspace(T begin, T end, size_t n) {
+		static_assert(std::is_floating_point<T>::value);
+		T step = n > 1 ? (end - begin) / T(n - 1) : T(0);
+		return DDIterator(LinearIterTrait<T>{ begin, step, end, 0, n, n > 1 ? n - 1 : size_t(-1) });
+	}
+
+	// n copies of value, the last one is moved out
+	template<class T>
+	struct RepeatIterTrait
+	{
+		T value;
+		size_t count;
+		using Type = T;
+		static inline constexpr bool FastCount = true;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return SizeBounds::Exact(count);
+		}
+
+		constexpr inline RepeatIterTrait(T v, size_t n) : value(std::move(v)), count(n) { }
+
+		template<class U = T, std::enable_if_t<std::is_integral<U>::value, int> = 0>
+		constexpr inline Progression<T> AsProgression() const noexcept {
+			return { value, 0, count };
+		}
+
+		template<class U = T, std::enable_if_t<std::is_integral<U>::value, int> = 0>
+		constexpr inline Progression<T> AsProgressionBack() const noexcept {
+			return { value, 0, count };
+		}
+
+		constexpr inline Option<T> Next() {
+			if (count == 0)
+				return {};
+			if (--count == 0)
+				return std::move(value);
+			return value;
+		}
+
+		constexpr inline Option<T> NextBack() {
+			return Next();
+		}
+
+		constexpr inline size_t NextBatch(T* out, size_t n) {
+			n = std::min(n, count);
+			std::fill_n(out, n, value);
+			count -= n;
+			return n;
+		}
+
+		constexpr inline size_t Advance(size_t n) noexcept {
+			n = std::min(n, count);
+			count -= n;
+			return n;
+		}
+
+		constexpr inline size_t AdvanceBack(size_t n) noexcept {
+			return Advance(n);
+		}
+
+		// keep the first n items, return the rest
+		constexpr inline RepeatIterTrait SplitAt(size_t n) {
+			n = std::min(n, count);
+			auto rest = RepeatIterTrait(value, count - n);
+			count = n;
+			return rest;
+		}
+
+		constexpr inline std::optional<RepeatIterTrait> Split() {
+			if (count < 2)
+				return {};
+			return SplitAt(count / 2);
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			while (count > 1) {
+				--count;
+				if (!func(acc, T(value)))
+					return false;
+			}
+			if (count == 0)
+				return true;
+			count = 0;
+			return func(acc, std::move(value));
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryRFold(Acc& acc, Func&& func) {
+			return TryFold(acc, func);
+		}
+	};
+
+	template<class T>
+	constexpr inline auto RepeatN(T value, size_t n) {
+		return DDIterator(RepeatIterTrait<T>(std::move(value), n));
+	}
+
+	// as many copies of value as fit in size_t, use Take() to stop earlier
+	template<class T>
+	constexpr inline auto Repeat(T value) {
+		return RepeatN(std::move(value), size_t(-1));
+	}
+
+	template<class T>
+	constexpr inline auto Once(T value) {
+		return RepeatN(std::move(value), 1);
+	}
+
+	// MoveOut moves the items out of the memory instead of copying them, see Drain()
+	template<class T, class Item = std::remove_const_t<T>, bool MoveOut = false>
+	struct ContiguousIterTrait
+	{
+		T* begin;
+		T* end;
+		using Type = Item;
+		static inline constexpr bool FastCount = true;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return SizeBounds::Exact(Length());
+		}
+
+		constexpr inline size_t Length() const noexcept {
+			return size_t(end - begin);
+		}
+
+		constexpr inline ContiguousIterTrait(T* data, size_t size)
+			: begin(data), end(data + size) { }
+
+		static constexpr inline Type Get(T& item) {
+			if constexpr (MoveOut) {
+				return Type(std::move(item));
+			} else {
+				return Type(item);
+			}
+		}
+
+		constexpr inline Option<Type> Next() {
+			if (begin == end)
+				return {};
+			return Get(*begin++);
+		}
+
+		constexpr inline Option<Type> NextBack() {
+			if (begin == end)
+				return {};
+			return Get(*--end);
+		}
+
+		constexpr inline size_t NextBatch(ValueOf<Type>* out, size_t n) noexcept {
+			n = std::min(n, Length());
+			for (size_t i = 0; i < n; ++i)
+				out[i] = Get(begin[i]);
+			begin += n;
+			return n;
+		}
+
+		constexpr inline size_t Advance(size_t n) noexcept {
+			n = std::min(n, Length());
+			begin += n;
+			return n;
+		}
+
+		constexpr inline size_t AdvanceBack(size_t n) noexcept {
+			n = std::min(n, Length());
+			end -= n;
+			return n;
+		}
+
+		// keep the first n items, return the rest
+		constexpr inline ContiguousIterTrait SplitAt(size_t n) noexcept {
+			n = std::min(n, Length());
+			auto rest = *this;
+			rest.begin = begin + n;
+			end = rest.begin;
+			return rest;
+		}
+
+		constexpr inline std::optional<ContiguousIterTrait> Split() noexcept {
+			if (Length() < 2)
+				return {};
+			return SplitAt(Length() / 2);
+		}
+
+		template<class U = T, std::enable_if_t<std::is_same_v<std::remove_const_t<U>, Item>, int> = 0>
+		constexpr inline Slice<const Item> AsSlice() const noexcept {
+			return { begin, Length() };
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			while (begin != end) {
+				if (!func(acc, Get(*begin++)))
+					return false;
+			}
+			return true;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryRFold(Acc& acc, Func&& func) {
+			while (begin != end) {
+				if (!func(acc, Get(*--end)))
+					return false;
+			}
+			return true;
+		}
+	};
+
 	template<class DDTrait>
-	inline constexpr auto DDIterator<DDTrait>::Enumerate() const noexcept {
-		return DDRange(size_t(0), size_t(-1)).Zip(*this);
+	inline constexpr auto DDIterator<DDTrait>::Enumerate(size_t start) const noexcept {
+		return DDRange(start, size_t(-1)).Zip(*this);
 	}
 
 	template<class DDTrait>
-	inline constexpr std::optional<typename DDIterator<DDTrait>::Type> DDIterator<DDTrait>::Nth(size_t n) const noexcept {
+	inline constexpr Option<typename DDIterator<DDTrait>::Type> DDIterator<DDTrait>::Nth(size_t n) const noexcept {
 		auto it = this->Skip(n);
 		return it.Next();
 	}
 
+	// skipping advances the iterator right away, so Skip(a).Skip(b) never nests
 	template<class Iter>
 	inline constexpr auto DDSkipImpl(Iter it, size_t n) {
-		while (n-- && it.Next());
+		it.Advance(n);
 		return it;
 	}
 
@@ -181,37 +968,120 @@ namespace Iter
 	struct DDTakeIterTrait
 	{
 		Iter iter;
+		size_t n;
+		bool trimmed = false;
 		using Type = typename Iter::Type;
 		static inline constexpr bool FastCount = Iter::FastCount;
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				return iter.Count();
-			}
-			return 0;
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return iter.SizeHint().Min(n);
 		}
 
-		// TODO: this is not very lazy
-		constexpr inline DDTakeIterTrait(Iter i, size_t n) : iter(i) {
-			size_t len = iter.Count();
-			if (len < n)
-				return;
-			size_t skipBack = len - n;
-			while (skipBack-- && iter.NextBack());
-		}
+		constexpr inline DDTakeIterTrait(Iter i, size_t n) : iter(std::move(i)), n(n) { }
 
-		constexpr inline std::optional<Type> Next() {
+		constexpr inline Option<Type> Next() {
+			if (n == 0)
+				return {};
+			--n;
 			return iter.Next();
 		}
 
-		constexpr inline std::optional<Type> NextBack() {
+		constexpr inline Option<Type> NextBack() {
+			if (n == 0)
+				return {};
+			Trim();
+			--n;
 			return iter.NextBack();
 		}
+
+		template<class U = Iter, std::enable_if_t<U::FastAdvance, int> = 0>
+		constexpr inline size_t Advance(size_t k) noexcept {
+			k = iter.Advance(std::min(k, n));
+			n -= k;
+			return k;
+		}
+
+		template<class U = Iter, std::enable_if_t<HasAsSlice<U>::value, int> = 0>
+		constexpr inline auto AsSlice() const noexcept {
+			return iter.AsSlice().First(n);
+		}
+
+		template<class U = Iter, std::enable_if_t<HasAsProgression<U>::value, int> = 0>
+		constexpr inline auto AsProgression() const noexcept {
+			return iter.AsProgression().Take(n);
+		}
+
+		// the back starts past the items Trim() drops
+		template<class U = Iter, std::enable_if_t<HasAsProgressionBack<U>::value, int> = 0>
+		constexpr inline auto AsProgressionBack() const noexcept {
+			auto prog = iter.AsProgressionBack();
+			return prog.Skip(prog.count - std::min(prog.count, n));
+		}
+
+		template<class U = Iter, std::enable_if_t<U::FastBatch, int> = 0>
+		constexpr inline size_t NextBatch(ValueOf<Type>* out, size_t k) {
+			k = iter.NextBatch(out, std::min(k, n));
+			n -= k;
+			return k;
+		}
+
+		template<class U = Iter, std::enable_if_t<U::FastAdvanceBack, int> = 0>
+		constexpr inline size_t AdvanceBack(size_t k) noexcept {
+			Trim();
+			k = iter.AdvanceBack(std::min(k, n));
+			n -= k;
+			return k;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			if (n == 0)
+				return true;
+			bool res = true;
+			iter.TryFold(acc, [&](Acc& a, auto&& v) {
+				--n;
+				res = func(a, std::forward<decltype(v)>(v));
+				return res && n != 0;
+			});
+			return res;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryRFold(Acc& acc, Func&& func) {
+			if (n == 0)
+				return true;
+			Trim();
+			bool res = true;
+			iter.TryRFold(acc, [&](Acc& a, auto&& v) {
+				--n;
+				res = func(a, std::forward<decltype(v)>(v));
+				return res && n != 0;
+			});
+			return res;
+		}
+
+	private:
+		// drop the items past the first n from the back of iter, done once before the first back access
+		constexpr inline void Trim() {
+			if (trimmed)
+				return;
+			trimmed = true;
+			size_t len = iter.Count();
+			if (len > n)
+				iter.AdvanceBack(len - n);
+		}
 	};
 
 	template<class Iter>
 	inline constexpr auto DDTakeImpl(Iter it, size_t n) {
-		return DDIterator(DDTakeIterTrait<Iter>{ it, n });
+		return DDIterator(DDTakeIterTrait<Iter>{ std::move(it), n });
+	}
+
+	// Take(a).Take(b) becomes Take(min(a, b))
+	template<class Iter>
+	inline constexpr auto DDTakeImpl(DDIterator<DDTakeIterTrait<Iter>> it, size_t n) {
+		const auto& take = it.GetTrait();
+		return DDTakeImpl(take.iter, std::min(take.n, n));
 	}
 
 	template<class DDTrait>
@@ -224,44 +1094,93 @@ namespace Iter
 	{
 		Iter iter;
 		size_t n;
+		bool trimmed = false;
 		using Type = typename Iter::Type;
 		static inline constexpr bool FastCount = Iter::FastCount;
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				auto size = iter.Count();
-				return size / n + size % n;
-			}
-			return 0;
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return iter.SizeHint().Step(n);
+		}
+
+		constexpr inline DDStepByIterTrait(Iter i, size_t n) : iter(std::move(i)), n(n) { }
+
+		template<class U = Iter, std::enable_if_t<HasAsProgression<U>::value, int> = 0>
+		constexpr inline auto AsProgression() const noexcept {
+			return iter.AsProgression().Step(n);
 		}
 
-		constexpr inline DDStepByIterTrait(Iter i, size_t n) : iter(i), n(n) { }
+		template<class U = Iter, std::enable_if_t<HasAsProgressionBack<U>::value, int> = 0>
+		constexpr inline auto AsProgressionBack() const noexcept {
+			auto prog = iter.AsProgressionBack();
+			return prog.Skip(prog.count == 0 ? 0 : (prog.count - 1) % n).Step(n);
+		}
 
 		constexpr inline auto Next() {
 			auto v = iter.Next();
-			Skip(n - 1);
+			iter.Advance(n - 1);
 			return v;
 		}
 
 		constexpr inline auto NextBack() {
+			Trim();
 			auto v = iter.NextBack();
-			SkipBack(n - 1);
+			iter.AdvanceBack(n - 1);
 			return v;
 		}
 
-	private:
-		constexpr inline void Skip(size_t n) {
-			while (n-- && iter.Next());
+		template<class U = Iter, std::enable_if_t<U::FastAdvance, int> = 0>
+		constexpr inline size_t Advance(size_t k) noexcept {
+			size_t steps = k > size_t(-1) / n ? size_t(-1) : k * n;
+			return (iter.Advance(steps) + n - 1) / n;
 		}
 
-		constexpr inline void SkipBack(size_t n) {
-			while (n-- && iter.NextBack());
+		template<class U = Iter, std::enable_if_t<U::FastAdvanceBack, int> = 0>
+		constexpr inline size_t AdvanceBack(size_t k) noexcept {
+			Trim();
+			size_t steps = k > size_t(-1) / n ? size_t(-1) : k * n;
+			return (iter.AdvanceBack(steps) + n - 1) / n;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			if constexpr (Iter::FastAdvance) {
+				while (auto v = iter.Next()) {
+					iter.Advance(n - 1);
+					if (!func(acc, std::forward<Type>(*v)))
+						return false;
+				}
+				return true;
+			}
+			size_t skip = 0;
+			bool res = iter.TryFold(acc, [&](Acc& a, auto&& v) {
+				if (skip != 0) {
+					--skip;
+					return true;
+				}
+				skip = n - 1;
+				return func(a, std::forward<decltype(v)>(v));
+			});
+			if (!res)
+				iter.Advance(skip);
+			return res;
+		}
+
+	private:
+		// the items are taken at multiples of n from the front, so the back has to drop the (len - 1) % n items
+		// past the last of them, done once before the first back access, the steps from either end keep it aligned
+		constexpr inline void Trim() {
+			if (trimmed)
+				return;
+			trimmed = true;
+			size_t len = iter.Count();
+			if (len != 0)
+				iter.AdvanceBack((len - 1) % n);
 		}
 	};
 
 	template<class Iter>
 	inline constexpr auto DDStepByImpl(Iter it, size_t n) {
-		return DDIterator(DDStepByIterTrait{ it, n });
+		return DDIterator(DDStepByIterTrait{ std::move(it), n });
 	}
 
 	template<class DDTrait>
@@ -269,47 +1188,324 @@ namespace Iter
 		return DDStepByImpl(*this, n);
 	}
 
+	// Slice views of n items at a time, the last one is shorter if the items run out unless Exact is set,
+	// contiguous sources are viewed in place, others are copied into a buffer allocated once,
+	// so a slice is only valid until the iterator moves on
+	template<class Iter, bool Exact>
+	struct DDChunksIterTrait
+	{
+		using Item = ValueOf<typename Iter::Type>;
+		static inline constexpr bool InPlace = HasAsSlice<Iter>::value;
+
+		Iter iter;
+		size_t n;
+		std::vector<Item> buf;
+		// set by the first NextBack(), which takes or drops the remainder so that the back is aligned too
+		bool trimmed = false;
+		using Type = Slice<const Item>;
+		static inline constexpr bool FastCount = Iter::FastCount;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			auto hint = iter.SizeHint();
+			return Exact ? hint.Chunks(n) : hint.Step(n);
+		}
+
+		// no chunk holds more items than the upstream has left
+		inline DDChunksIterTrait(Iter i, size_t n) : iter(std::move(i)), n(n) {
+			if constexpr (!InPlace) {
+				buf.resize(std::min(n, iter.SizeHint().upper.value_or(n)));
+			}
+		}
+
+		inline Option<Type> Next() {
+			if constexpr (InPlace) {
+				auto slice = iter.AsSlice();
+				size_t m = std::min(n, slice.size());
+				if (m == 0 || (Exact && m < n))
+					return {};
+				iter.Advance(m);
+				return slice.First(m);
+			}
+			else {
+				size_t m = iter.NextBatch(buf.data(), buf.size());
+				if (m == 0 || (Exact && m < n))
+					return {};
+				return Type(buf.data(), m);
+			}
+		}
+
+		// the chunks are aligned to the front, so the last one holds the remainder,
+		// the items are only counted once, after that the rest is a multiple of n
+		inline Option<Type> NextBack() {
+			size_t m = n;
+			if (!trimmed) {
+				trimmed = true;
+				size_t rem = iter.Count() % n;
+				if constexpr (Exact) {
+					iter.AdvanceBack(rem);
+				}
+				else if (rem != 0) {
+					m = rem;
+				}
+			}
+			if constexpr (InPlace) {
+				auto slice = iter.AsSlice();
+				m = std::min(m, slice.size());
+				if (m == 0)
+					return {};
+				iter.AdvanceBack(m);
+				return Type(slice.data() + slice.size() - m, m);
+			}
+			else {
+				auto last = iter.NextBack();
+				if (!last)
+					return {};
+				buf[m - 1] = std::forward<typename Iter::Type>(*last);
+				for (size_t i = m - 1; i-- > 0;)
+					buf[i] = std::forward<typename Iter::Type>(*iter.NextBack());
+				return Type(buf.data(), m);
+			}
+		}
+
+		template<class U = Iter, std::enable_if_t<U::FastAdvance, int> = 0>
+		constexpr inline size_t Advance(size_t k) noexcept {
+			size_t steps = k > size_t(-1) / n ? size_t(-1) : k * n;
+			size_t m = iter.Advance(steps);
+			return Exact ? m / n : (m + n - 1) / n;
+		}
+	};
+
+	template<class Iter>
+	inline constexpr auto DDChunksImpl(Iter it, size_t n) {
+		return DDIterator(DDChunksIterTrait<Iter, false>(std::move(it), std::max(n, size_t(1))));
+	}
+
+	template<class Iter>
+	inline constexpr auto DDChunksExactImpl(Iter it, size_t n) {
+		return DDIterator(DDChunksIterTrait<Iter, true>(std::move(it), std::max(n, size_t(1))));
+	}
+
+	template<class DDTrait>
+	inline constexpr auto DDIterator<DDTrait>::Chunks(size_t n) const {
+		return DDChunksImpl(*this, n);
+	}
+
+	template<class DDTrait>
+	inline constexpr auto DDIterator<DDTrait>::ChunksExact(size_t n) const {
+		return DDChunksExactImpl(*this, n);
+	}
+
+	// Slice views of every n consecutive items, contiguous sources are viewed in place,
+	// others are written twice into a ring buffer of 2n items so that each window is contiguous,
+	// a slice is only valid until the iterator moves on, only contiguous sources can be walked from the back
+	template<class Iter>
+	struct DDWindowsIterTrait
+	{
+		using Item = ValueOf<typename Iter::Type>;
+		static inline constexpr bool InPlace = HasAsSlice<Iter>::value;
+
+		Iter iter;
+		size_t n;
+		std::vector<Item> buf;
+		// items of the first window read so far, start of the window in buf
+		size_t filled = 0, pos = 0;
+		using Type = Slice<const Item>;
+		static inline constexpr bool FastCount = Iter::FastCount;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			if (n == 0)
+				return SizeBounds::Exact(0);
+			auto hint = iter.SizeHint();
+			return filled == n && !InPlace ? hint : hint.Windows(n - filled);
+		}
+
+		// the buffer stays empty if the upstream can't fill a single window
+		inline DDWindowsIterTrait(Iter i, size_t n) : iter(std::move(i)), n(n) {
+			if constexpr (!InPlace) {
+				if (n <= iter.SizeHint().upper.value_or(n))
+					buf.resize(2 * n);
+			}
+		}
+
+		inline Option<Type> Next() {
+			if (n == 0)
+				return {};
+			if constexpr (InPlace) {
+				auto slice = iter.AsSlice();
+				if (slice.size() < n)
+					return {};
+				iter.Advance(1);
+				return slice.First(n);
+			}
+			else {
+				if (buf.empty())
+					return {};
+				if (filled < n) {
+					for (; filled < n; ++filled) {
+						auto v = iter.Next();
+						if (!v)
+							return {};
+						buf[filled] = std::forward<typename Iter::Type>(*v);
+						buf[filled + n] = buf[filled];
+					}
+					return Type(buf.data(), n);
+				}
+				auto v = iter.Next();
+				if (!v)
+					return {};
+				// the oldest item is replaced in both copies, the window starts right after it
+				buf[pos] = std::forward<typename Iter::Type>(*v);
+				buf[pos + n] = buf[pos];
+				pos = pos + 1 == n ? 0 : pos + 1;
+				return Type(buf.data() + pos, n);
+			}
+		}
+
+		template<class U = Iter, std::enable_if_t<HasAsSlice<U>::value, int> = 0>
+		constexpr inline Option<Type> NextBack() {
+			auto slice = iter.AsSlice();
+			if (n == 0 || slice.size() < n)
+				return {};
+			iter.AdvanceBack(1);
+			return Type(slice.data() + slice.size() - n, n);
+		}
+
+		template<class U = Iter, std::enable_if_t<HasAsSlice<U>::value, int> = 0>
+		constexpr inline size_t Advance(size_t k) noexcept {
+			k = std::min(k, SizeHint().lower);
+			iter.Advance(k);
+			return k;
+		}
+
+		template<class U = Iter, std::enable_if_t<HasAsSlice<U>::value, int> = 0>
+		constexpr inline size_t AdvanceBack(size_t k) noexcept {
+			k = std::min(k, SizeHint().lower);
+			iter.AdvanceBack(k);
+			return k;
+		}
+	};
+
+	template<class Iter>
+	inline constexpr auto DDWindowsImpl(Iter it, size_t n) {
+		return DDIterator(DDWindowsIterTrait<Iter>(std::move(it), n));
+	}
+
+	template<class DDTrait>
+	inline constexpr auto DDIterator<DDTrait>::Windows(size_t n) const {
+		return DDWindowsImpl(*this, n);
+	}
+
 	template<class T1, class T2>
 	struct DDZipIterTrait
 	{
 		DDIterator<T1> iter1;
 		DDIterator<T2> iter2;
+		bool trimmed = false;
 		using Type = std::tuple<typename T1::Type, typename T2::Type>;
 		static inline constexpr bool FastCount = T1::FastCount && T2::FastCount;
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				return std::min(iter1.Count(), iter2.Count());
-			}
-			return 0;
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return iter1.SizeHint().Min(iter2.SizeHint());
 		}
 
-		constexpr inline DDZipIterTrait(DDIterator<T1> l, DDIterator<T2> r) : iter1(l), iter2(r) { }
+		constexpr inline DDZipIterTrait(DDIterator<T1> l, DDIterator<T2> r) : iter1(std::move(l)), iter2(std::move(r)) { }
+
+		template<class U = T1, std::enable_if_t<HasNextBatch<U>::value && HasNextBatch<T2>::value
+			&& std::is_default_constructible_v<typename U::Type> && std::is_default_constructible_v<typename T2::Type>, int> = 0>
+		constexpr inline size_t NextBatch(ValueOf<Type>* out, size_t n) {
+			constexpr size_t batch = BatchSizeOf<typename T1::Type, typename T2::Type>;
+			typename T1::Type buf1[batch];
+			typename T2::Type buf2[batch];
+			size_t k = 0;
+			while (k < n) {
+				size_t want = std::min(n - k, batch);
+				size_t m = std::min(iter1.NextBatch(buf1, want), iter2.NextBatch(buf2, want));
+				for (size_t i = 0; i < m; ++i)
+					out[k + i] = Type(buf1[i], buf2[i]);
+				k += m;
+				if (m < want)
+					break;
+			}
+			return k;
+		}
 
-		constexpr inline std::optional<Type> Next() {
+		constexpr inline Option<Type> Next() {
 			if (auto next1 = iter1.Next()) {
 				if (auto next2 = iter2.Next()) {
-					return std::make_tuple(next1.value(), next2.value());
+					return Type(std::forward<typename T1::Type>(*next1), std::forward<typename T2::Type>(*next2));
 				}
 			}
 
 			return {};
 		}
 
-		constexpr inline std::optional<Type> NextBack() {
+		constexpr inline Option<Type> NextBack() {
+			Trim();
 			if (auto next1 = iter1.NextBack()) {
 				if (auto next2 = iter2.NextBack()) {
-					return std::make_tuple(next1.value(), next2.value());
+					return Type(std::forward<typename T1::Type>(*next1), std::forward<typename T2::Type>(*next2));
 				}
 			}
 
 			return {};
 		}
+
+		template<class U = T1, std::enable_if_t<HasAdvance<U>::value && HasAdvance<T2>::value, int> = 0>
+		constexpr inline size_t Advance(size_t n) noexcept {
+			return std::min(iter1.Advance(n), iter2.Advance(n));
+		}
+
+		template<class U = T1, std::enable_if_t<HasAdvanceBack<U>::value && HasAdvanceBack<T2>::value, int> = 0>
+		constexpr inline size_t AdvanceBack(size_t n) noexcept {
+			Trim();
+			return std::min(iter1.AdvanceBack(n), iter2.AdvanceBack(n));
+		}
+
+		template<class U = T1, std::enable_if_t<HasSplitAt<U>::value && HasSplitAt<T2>::value, int> = 0>
+		constexpr inline DDZipIterTrait SplitAt(size_t n) {
+			return { iter1.SplitAt(n), iter2.SplitAt(n) };
+		}
+
+		// both sides are cut at the same position, so the length must be known
+		template<class U = T1, std::enable_if_t<FastCount && HasSplitAt<U>::value && HasSplitAt<T2>::value, int> = 0>
+		constexpr inline std::optional<DDZipIterTrait> Split() {
+			size_t len = SizeHint().lower;
+			if (len < 2)
+				return {};
+			return SplitAt(len / 2);
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			bool res = true;
+			iter1.TryFold(acc, [&](Acc& a, auto&& v1) {
+				auto v2 = iter2.Next();
+				if (!v2)
+					return false;
+				res = func(a, Type(std::forward<decltype(v1)>(v1), std::forward<typename T2::Type>(*v2)));
+				return res;
+			});
+			return res;
+		}
+
+	private:
+		// the pairs are matched from the front, so the longer side drops its extra items from the back
+		// before the first back access
+		constexpr inline void Trim() {
+			if (trimmed)
+				return;
+			trimmed = true;
+			size_t len1 = iter1.Count(), len2 = iter2.Count();
+			if (len1 > len2)
+				iter1.AdvanceBack(len1 - len2);
+			else if (len2 > len1)
+				iter2.AdvanceBack(len2 - len1);
+		}
 	};
 
 	template<class T1, class T2>
 	inline constexpr auto DDZipImpl(DDIterator<T1> l, DDIterator<T2> r) {
-		return DDIterator(DDZipIterTrait{ l, r });
+		return DDIterator(DDZipIterTrait{ std::move(l), std::move(r) });
 	}
 
 	template<class DDTrait>
@@ -324,46 +1520,135 @@ namespace Iter
 		static_assert(std::is_same<typename T1::Type, typename T2::Type>::value, "Chained iterators must have same value type");
 		DDIterator<T1> iter1;
 		DDIterator<T2> iter2;
+		// false once the iterator is exhausted or was given to the other half by Split()
+		bool has1 = true;
+		bool has2 = true;
 		using Type = typename T1::Type;
 		static inline constexpr bool FastCount = T1::FastCount && T2::FastCount;
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				return iter1.Count() + iter2.Count();
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			auto res = SizeBounds::Exact(0);
+			if (has1)
+				res = res.Add(iter1.SizeHint());
+			if (has2)
+				res = res.Add(iter2.SizeHint());
+			return res;
+		}
+
+		constexpr inline DDChainIterTrait(DDIterator<T1> l, DDIterator<T2> r) : iter1(std::move(l)), iter2(std::move(r)) { }
+
+		template<class U = T1, std::enable_if_t<HasNextBatch<U>::value && HasNextBatch<T2>::value, int> = 0>
+		constexpr inline size_t NextBatch(ValueOf<Type>* out, size_t n) {
+			size_t k = 0;
+			if (has1) {
+				k = iter1.NextBatch(out, n);
+				if (k == n)
+					return k;
+				has1 = false;
 			}
-			return 0;
+			if (has2)
+				k += iter2.NextBatch(out + k, n - k);
+			return k;
 		}
 
-		constexpr inline DDChainIterTrait(DDIterator<T1> l, DDIterator<T2> r) : iter1(l), iter2(r) { }
+		constexpr inline Option<Type> Next() {
+			if (has1) {
+				if (auto next = iter1.Next()) {
+					return next;
+				}
+				has1 = false;
+			}
+
+			if (has2) {
+				return iter2.Next();
+			}
 
-		constexpr inline std::optional<Type> Next() {
-			if (auto next = iter1.Next()) {
-				return next.value();
+			return {};
+		}
+
+		constexpr inline Option<Type> NextBack() {
+			if (has2) {
+				if (auto next = iter2.NextBack()) {
+					return next;
+				}
+				has2 = false;
 			}
 
-			if (auto next = iter2.Next()) {
-				return next.value();
+			if (has1) {
+				return iter1.NextBack();
 			}
 
 			return {};
 		}
 
-		constexpr inline std::optional<Type> NextBack() {
-			if (auto next = iter2.NextBack()) {
-				return next.value();
+		template<class U = T1, std::enable_if_t<HasAdvance<U>::value && HasAdvance<T2>::value, int> = 0>
+		constexpr inline size_t Advance(size_t n) noexcept {
+			size_t k = has1 ? iter1.Advance(n) : 0;
+			if (k < n && has2)
+				k += iter2.Advance(n - k);
+			return k;
+		}
+
+		template<class U = T1, std::enable_if_t<HasAdvanceBack<U>::value && HasAdvanceBack<T2>::value, int> = 0>
+		constexpr inline size_t AdvanceBack(size_t n) noexcept {
+			size_t k = has2 ? iter2.AdvanceBack(n) : 0;
+			if (k < n && has1)
+				k += iter1.AdvanceBack(n - k);
+			return k;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			if (has1) {
+				if (!iter1.TryFold(acc, func))
+					return false;
+				has1 = false;
 			}
+			return !has2 || iter2.TryFold(acc, func);
+		}
 
-			if (auto next = iter1.NextBack()) {
-				return next.value();
+		template<class Acc, class Func>
+		constexpr inline bool TryRFold(Acc& acc, Func&& func) {
+			if (has2) {
+				if (!iter2.TryRFold(acc, func))
+					return false;
+				has2 = false;
 			}
+			return !has1 || iter1.TryRFold(acc, func);
+		}
 
+		// split at the border of the two iterators first, then inside the remaining one
+		template<class U = T1, std::enable_if_t<HasSplit<U>::value && HasSplit<T2>::value, int> = 0>
+		constexpr inline std::optional<DDChainIterTrait> Split() {
+			if (has1 && has2) {
+				auto rest = *this;
+				rest.has1 = false;
+				has2 = false;
+				return rest;
+			}
+			if (has1) {
+				auto half = iter1.Split();
+				if (!half)
+					return {};
+				DDChainIterTrait rest(*half, iter2);
+				rest.has2 = false;
+				return rest;
+			}
+			if (has2) {
+				auto half = iter2.Split();
+				if (!half)
+					return {};
+				DDChainIterTrait rest(iter1, *half);
+				rest.has1 = false;
+				return rest;
+			}
 			return {};
 		}
 	};
 
 	template<class T1, class T2>
 	inline constexpr auto DDChainImpl(DDIterator<T1> l, DDIterator<T2> r) {
-		return DDIterator(DDChainIterTrait{ l, r });
+		return DDIterator(DDChainIterTrait{ std::move(l), std::move(r) });
 	}
 
 	template<class DDTrait>
@@ -380,33 +1665,95 @@ namespace Iter
 		using Type = Ret;
 		static inline constexpr bool FastCount = T::FastCount;
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				return iter.Count();
-			}
-			return 0;
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return iter.SizeHint();
 		}
 
-		constexpr inline DDMapIterTrait(DDIterator<T> it, Func f) : iter(it), func(f) { }
+		constexpr inline DDMapIterTrait(DDIterator<T> it, Func f) : iter(std::move(it)), func(std::move(f)) { }
 
-		constexpr inline std::optional<Ret> Next() {
+		constexpr inline Option<Ret> Next() {
 			if (auto next = iter.Next()) {
-				return func(next.value());
+				return func(std::forward<typename T::Type>(*next));
 			}
 			return {};
 		}
 
-		constexpr inline std::optional<Ret> NextBack() {
+		constexpr inline Option<Ret> NextBack() {
 			if (auto next = iter.NextBack()) {
-				return func(next.value());
+				return func(std::forward<typename T::Type>(*next));
 			}
 			return {};
 		}
+
+		// map whole blocks of the inner items
+		template<class U = T, std::enable_if_t<HasNextBatch<U>::value && std::is_default_constructible_v<typename U::Type>, int> = 0>
+		constexpr inline size_t NextBatch(ValueOf<Ret>* out, size_t n) {
+			constexpr size_t batch = BatchSizeOf<typename T::Type>;
+			typename T::Type buf[batch];
+			size_t k = 0;
+			while (k < n) {
+				size_t want = std::min(n - k, batch);
+				size_t m = iter.NextBatch(buf, want);
+				for (size_t i = 0; i < m; ++i)
+					out[k + i] = func(std::move(buf[i]));
+				k += m;
+				if (m < want)
+					break;
+			}
+			return k;
+		}
+
+		// skipped items are not passed to func
+		template<class U = T, std::enable_if_t<HasAdvance<U>::value, int> = 0>
+		constexpr inline size_t Advance(size_t n) noexcept {
+			return iter.Advance(n);
+		}
+
+		template<class U = T, std::enable_if_t<HasAdvanceBack<U>::value, int> = 0>
+		constexpr inline size_t AdvanceBack(size_t n) noexcept {
+			return iter.AdvanceBack(n);
+		}
+
+		template<class U = T, std::enable_if_t<HasSplitAt<U>::value, int> = 0>
+		constexpr inline DDMapIterTrait SplitAt(size_t n) {
+			return { iter.SplitAt(n), func };
+		}
+
+		template<class U = T, std::enable_if_t<HasSplit<U>::value, int> = 0>
+		constexpr inline std::optional<DDMapIterTrait> Split() {
+			if (auto rest = iter.Split())
+				return DDMapIterTrait{ *rest, func };
+			return {};
+		}
+
+		template<class Acc, class Fold>
+		constexpr inline bool TryFold(Acc& acc, Fold&& fold) {
+			return iter.TryFold(acc, [&](Acc& a, auto&& v) {
+				return fold(a, func(std::forward<decltype(v)>(v)));
+			});
+		}
+
+		template<class Acc, class Fold>
+		constexpr inline bool TryRFold(Acc& acc, Fold&& fold) {
+			return iter.TryRFold(acc, [&](Acc& a, auto&& v) {
+				return fold(a, func(std::forward<decltype(v)>(v)));
+			});
+		}
 	};
 
 	template<class T, class Func>
 	inline constexpr auto DDMapImpl(DDIterator<T> it, Func f) {
-		return DDIterator(DDMapIterTrait<T, Func, decltype(f(it.Next().value()))>{ it, f });
+		return DDIterator(DDMapIterTrait<T, Func, decltype(f(it.Next().value()))>{ std::move(it), std::move(f) });
+	}
+
+	// Map(f).Map(g) becomes Map(g(f(x)))
+	template<class T, class F, class Ret, class Func>
+	inline constexpr auto DDMapImpl(DDIterator<DDMapIterTrait<T, F, Ret>> it, Func g) {
+		const auto& map = it.GetTrait();
+		auto fused = [f = map.func, g = std::move(g)](auto&& v) mutable -> decltype(auto) {
+			return g(f(std::forward<decltype(v)>(v)));
+		};
+		return DDMapImpl(map.iter, std::move(fused));
 	}
 
 	template<class DDTrait>
@@ -421,39 +1768,99 @@ namespace Iter
 		DDIterator<T> iter;
 		Func func;
 		using Type = typename T::Type;
-		static inline constexpr bool FastCount = T::FastCount;
+		static inline constexpr bool FastCount = false;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return { 0, iter.SizeHint().upper };
+		}
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				return iter.Count();
+		constexpr inline DDFilterIterTrait(DDIterator<T> it, Func f) : iter(std::move(it)), func(std::move(f)) { }
+
+		// fill out with inner items and move the matching ones to its front,
+		// arithmetic items are tested a block at a time and compacted without branches
+		template<class U = T, std::enable_if_t<HasNextBatch<U>::value, int> = 0>
+		constexpr inline size_t NextBatch(ValueOf<Type>* out, size_t n) {
+			size_t k = 0;
+			while (k < n) {
+				if constexpr (std::is_arithmetic_v<Type>) {
+					uint8_t keep[BatchSize];
+					size_t want = std::min(n - k, BatchSize);
+					size_t got = iter.NextBatch(out + k, want);
+					for (size_t i = 0; i < got; ++i)
+						keep[i] = bool(func(out[k + i]));
+					k += Simd::Compact(out + k, keep, got);
+					if (got < want)
+						break;
+				} else {
+					size_t end = k + iter.NextBatch(out + k, n - k);
+					for (size_t i = k; i < end; ++i) {
+						if (func(out[i])) {
+							if (k != i)
+								out[k] = std::move(out[i]);
+							++k;
+						}
+					}
+					if (end < n)
+						break;
+				}
 			}
-			return 0;
+			return k;
 		}
 
-		constexpr inline DDFilterIterTrait(DDIterator<T> it, Func f) : iter(it), func(f) { }
+		// the halves are cut by position, not by the number of matching items
+		template<class U = T, std::enable_if_t<HasSplit<U>::value, int> = 0>
+		constexpr inline std::optional<DDFilterIterTrait> Split() {
+			if (auto rest = iter.Split())
+				return DDFilterIterTrait{ *rest, func };
+			return {};
+		}
 
-		constexpr inline std::optional<Type> Next() {
+		constexpr inline Option<Type> Next() {
 			while (auto next = iter.Next()) {
 				if (!func(next.value()))
 					continue;
-				return next.value();
+				return next;
 			}
 			return {};
 		}
 
-		constexpr inline std::optional<Type> NextBack() {
+		constexpr inline Option<Type> NextBack() {
 			while (auto next = iter.NextBack()) {
 				if (!func(next.value()))
 					continue;
-				return next.value();
+				return next;
 			}
 			return {};
 		}
+
+		template<class Acc, class Fold>
+		constexpr inline bool TryFold(Acc& acc, Fold&& fold) {
+			return iter.TryFold(acc, [&](Acc& a, auto&& v) {
+				return !func(v) || fold(a, std::forward<decltype(v)>(v));
+			});
+		}
+
+		template<class Acc, class Fold>
+		constexpr inline bool TryRFold(Acc& acc, Fold&& fold) {
+			return iter.TryRFold(acc, [&](Acc& a, auto&& v) {
+				return !func(v) || fold(a, std::forward<decltype(v)>(v));
+			});
+		}
 	};
 
 	template<class T, class Func>
 	inline constexpr auto DDFilterImpl(DDIterator<T> it, Func f) {
-		return DDIterator(DDFilterIterTrait<T, Func>{ it, f });
+		return DDIterator(DDFilterIterTrait<T, Func>{ std::move(it), std::move(f) });
+	}
+
+	// Filter(p).Filter(q) becomes Filter(p(x) && q(x))
+	template<class T, class F, class Func>
+	inline constexpr auto DDFilterImpl(DDIterator<DDFilterIterTrait<T, F>> it, Func q) {
+		const auto& filter = it.GetTrait();
+		auto fused = [p = filter.func, q = std::move(q)](auto& v) mutable {
+			return bool(p(v)) && bool(q(v));
+		};
+		return DDFilterImpl(filter.iter, std::move(fused));
 	}
 
 	template<class DDTrait>
@@ -470,27 +1877,54 @@ namespace Iter
 
 		DDIterator<T> iter;
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				return iter.Count();
-			}
-			return 0;
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return iter.SizeHint();
 		}
 
-		constexpr inline DDRevIterTrait(DDIterator<T> it) : iter(it) { }
+		constexpr inline DDRevIterTrait(DDIterator<T> it) : iter(std::move(it)) { }
 
-		constexpr inline std::optional<Type> Next() {
+		constexpr inline Option<Type> Next() {
 			return iter.NextBack();
 		}
 
-		constexpr inline std::optional<Type> NextBack() {
+		constexpr inline Option<Type> NextBack() {
 			return iter.Next();
 		}
+
+		template<class U = T, std::enable_if_t<HasAdvanceBack<U>::value, int> = 0>
+		constexpr inline size_t Advance(size_t n) noexcept {
+			return iter.AdvanceBack(n);
+		}
+
+		template<class U = T, std::enable_if_t<HasAdvance<U>::value, int> = 0>
+		constexpr inline size_t AdvanceBack(size_t n) noexcept {
+			return iter.Advance(n);
+		}
+
+		template<class U = T, std::enable_if_t<HasAsProgressionBack<U>::value, int> = 0>
+		constexpr inline auto AsProgression() const noexcept {
+			return iter.AsProgressionBack();
+		}
+
+		template<class U = T, std::enable_if_t<HasAsProgression<U>::value, int> = 0>
+		constexpr inline auto AsProgressionBack() const noexcept {
+			return iter.AsProgression();
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			return iter.TryRFold(acc, func);
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryRFold(Acc& acc, Func&& func) {
+			return iter.TryFold(acc, func);
+		}
 	};
 
 	template<class T>
 	inline constexpr auto DDRevImpl(DDIterator<T> it) {
-		return DDIterator(DDRevIterTrait{ it });
+		return DDIterator(DDRevIterTrait{ std::move(it) });
 	}
 
 	template<class DDTrait>
@@ -0,0 +1,690 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ITER_HAS_IO_URING 1
+#include <string.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif
+#include "SDIterator.h"
+#include "DDIterator.h"
+#include "Parallel.h"
+
+namespace Iter
+{
+	// read-only mapping of a whole file, throws std::system_error if the file can't be opened or mapped
+	class MappedFile
+	{
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+#if defined(_WIN32)
+		HANDLE m_mapping = nullptr;
+#endif
+
+	public:
+		inline explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+			HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				throw std::system_error(int(GetLastError()), std::system_category(), path);
+			LARGE_INTEGER size{};
+			DWORD err = 0;
+			if (!GetFileSizeEx(file, &size)) {
+				err = GetLastError();
+			}
+			else if (size.QuadPart != 0) {
+				m_size = size_t(size.QuadPart);
+				m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (m_mapping)
+					m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+				if (!m_data)
+					err = GetLastError();
+			}
+			CloseHandle(file);
+			if (err != 0) {
+				if (m_mapping)
+					CloseHandle(m_mapping);
+				throw std::system_error(int(err), std::system_category(), path);
+			}
+#else
+			int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0)
+				throw std::system_error(errno, std::generic_category(), path);
+			struct stat st;
+			int err = fstat(fd, &st) != 0 ? errno : 0;
+			if (err == 0 && st.st_size != 0) {
+				m_size = size_t(st.st_size);
+				void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (data == MAP_FAILED)
+					err = errno;
+				else
+					m_data = (const char*)data;
+			}
+			close(fd);
+			if (err != 0)
+				throw std::system_error(err, std::generic_category(), path);
+#endif
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		inline ~MappedFile() {
+			if (!m_data)
+				return;
+#if defined(_WIN32)
+			UnmapViewOfFile(m_data);
+			CloseHandle(m_mapping);
+#else
+			munmap((void*)m_data, m_size);
+#endif
+		}
+
+		inline const char* Data() const noexcept {
+			return m_data;
+		}
+
+		inline size_t Size() const noexcept {
+			return m_size;
+		}
+
+		// tell the kernel the pages will be read in order so it reads ahead and drops them early,
+		// on Windows the file is opened with FILE_FLAG_SEQUENTIAL_SCAN instead
+		inline void AdviseSequential() const noexcept {
+#if !defined(_WIN32)
+			if (m_data)
+				madvise((void*)m_data, m_size, MADV_SEQUENTIAL);
+#endif
+		}
+	};
+
+	// lines of a mapped file without their "\n" or "\r\n", the last line doesn't need a line break,
+	// the items point into the mapping, which lives as long as any iterator over it
+	struct LinesIterTrait
+	{
+		std::shared_ptr<const MappedFile> file;
+		const char* begin;
+		const char* end;
+		using Type = std::string_view;
+		static inline constexpr bool FastCount = false;
+
+		// every line takes at least one byte
+		inline SizeBounds SizeHint() const noexcept {
+			return { size_t(begin != end), size_t(end - begin) };
+		}
+
+		inline Option<Type> Next() noexcept {
+			if (begin == end)
+				return {};
+			const char* lineEnd = Simd::FindByte(begin, size_t(end - begin), '\n');
+			const char* next = lineEnd ? lineEnd + 1 : end;
+			auto line = Line(begin, lineEnd ? lineEnd : end);
+			begin = next;
+			return line;
+		}
+
+		inline Option<Type> NextBack() noexcept {
+			if (begin == end)
+				return {};
+			const char* lineEnd = end[-1] == '\n' ? end - 1 : end;
+			const char* prev = Simd::FindLastByte(begin, size_t(lineEnd - begin), '\n');
+			const char* lineBegin = prev ? prev + 1 : begin;
+			end = lineBegin;
+			return Line(lineBegin, lineEnd);
+		}
+
+		// cut at the first line break past the middle, nullopt if the rest is a single line
+		inline std::optional<LinesIterTrait> Split() noexcept {
+			const char* mid = begin + (end - begin) / 2;
+			const char* cut = Simd::FindByte(mid, size_t(end - mid), '\n');
+			if (!cut || cut + 1 == end)
+				return {};
+			auto rest = *this;
+			rest.begin = cut + 1;
+			end = rest.begin;
+			return rest;
+		}
+
+	private:
+		static inline std::string_view Line(const char* b, const char* e) noexcept {
+			if (e != b && e[-1] == '\r')
+				--e;
+			return { b, size_t(e - b) };
+		}
+	};
+
+	inline auto Lines(const std::string& path) {
+		auto file = std::make_shared<const MappedFile>(path);
+		file->AdviseSequential();
+		return DDIterator(LinesIterTrait{ file, file->Data(), file->Data() + file->Size() });
+	}
+
+	// packed records of a trivially copyable T read straight from a mapped file, trailing bytes that don't
+	// make up a whole record are ignored, the mapping lives as long as any iterator over it
+	template<class T>
+	struct BinaryFileIterTrait
+	{
+		std::shared_ptr<const MappedFile> file;
+		ContiguousIterTrait<const T, T> records;
+		using Type = T;
+		static inline constexpr bool FastCount = true;
+
+		inline SizeBounds SizeHint() const noexcept {
+			return records.SizeHint();
+		}
+
+		inline Option<Type> Next() noexcept {
+			return records.Next();
+		}
+
+		inline Option<Type> NextBack() noexcept {
+			return records.NextBack();
+		}
+
+		inline size_t NextBatch(T* out, size_t n) noexcept {
+			return records.NextBatch(out, n);
+		}
+
+		inline size_t Advance(size_t n) noexcept {
+			return records.Advance(n);
+		}
+
+		inline size_t AdvanceBack(size_t n) noexcept {
+			return records.AdvanceBack(n);
+		}
+
+		inline Slice<const T> AsSlice() const noexcept {
+			return records.AsSlice();
+		}
+
+		// keep the first n records, return the rest, both halves share the mapping
+		inline BinaryFileIterTrait SplitAt(size_t n) noexcept {
+			return { file, records.SplitAt(n) };
+		}
+
+		inline std::optional<BinaryFileIterTrait> Split() noexcept {
+			if (auto rest = records.Split())
+				return BinaryFileIterTrait{ file, *rest };
+			return {};
+		}
+
+		template<class Acc, class Func>
+		inline bool TryFold(Acc& acc, Func&& func) {
+			return records.TryFold(acc, func);
+		}
+
+		template<class Acc, class Func>
+		inline bool TryRFold(Acc& acc, Func&& func) {
+			return records.TryRFold(acc, func);
+		}
+	};
+
+	template<class T>
+	inline auto FromBinaryFile(const std::string& path) {
+		static_assert(std::is_trivially_copyable<T>::value);
+		auto file = std::make_shared<const MappedFile>(path);
+		file->AdviseSequential();
+		// the mapping is page aligned, so every record is aligned for T
+		auto records = ContiguousIterTrait<const T, T>((const T*)file->Data(), file->Size() / sizeof(T));
+		return DDIterator(BinaryFileIterTrait<T>{ std::move(file), records });
+	}
+
+	// file opened for positional reads, the error is reported through err instead of an exception
+	class ReadOnlyFile
+	{
+#if defined(_WIN32)
+		HANDLE m_handle = INVALID_HANDLE_VALUE;
+#else
+		int m_fd = -1;
+#endif
+		uint64_t m_size = 0;
+
+	public:
+		inline ReadOnlyFile(const std::string& path, std::error_code& err) {
+#if defined(_WIN32)
+			m_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			LARGE_INTEGER size{};
+			if (m_handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_handle, &size))
+				err = std::error_code(int(GetLastError()), std::system_category());
+			m_size = uint64_t(size.QuadPart);
+#else
+			m_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			struct stat st;
+			if (m_fd < 0 || fstat(m_fd, &st) != 0)
+				err = std::error_code(errno, std::generic_category());
+			else
+				m_size = uint64_t(st.st_size);
+#endif
+		}
+
+		ReadOnlyFile(const ReadOnlyFile&) = delete;
+		ReadOnlyFile& operator=(const ReadOnlyFile&) = delete;
+
+		inline ~ReadOnlyFile() {
+#if defined(_WIN32)
+			if (m_handle != INVALID_HANDLE_VALUE)
+				CloseHandle(m_handle);
+#else
+			if (m_fd >= 0)
+				close(m_fd);
+#endif
+		}
+
+		inline uint64_t Size() const noexcept {
+			return m_size;
+		}
+
+#if !defined(_WIN32)
+		inline int Descriptor() const noexcept {
+			return m_fd;
+		}
+#endif
+
+		// read up to size bytes at offset, return the number of read bytes, 0 at the end of the file or on error
+		inline size_t ReadAt(void* buf, size_t size, uint64_t offset, std::error_code& err) const noexcept {
+#if defined(_WIN32)
+			OVERLAPPED ov{};
+			ov.Offset = DWORD(offset);
+			ov.OffsetHigh = DWORD(offset >> 32);
+			DWORD read = 0;
+			if (!ReadFile(m_handle, buf, DWORD(std::min(size, size_t(1) << 30)), &read, &ov)) {
+				if (DWORD code = GetLastError(); code != ERROR_HANDLE_EOF)
+					err = std::error_code(int(code), std::system_category());
+				return 0;
+			}
+			return size_t(read);
+#else
+			while (true) {
+				ssize_t read = pread(m_fd, buf, size, off_t(offset));
+				if (read >= 0)
+					return size_t(read);
+				if (errno != EINTR) {
+					err = std::error_code(errno, std::generic_category());
+					return 0;
+				}
+			}
+#endif
+		}
+	};
+
+#ifdef ITER_HAS_IO_URING
+	// submission and completion rings of an io_uring instance set up with raw system calls
+	class UringQueue
+	{
+		int m_fd = -1;
+		void* m_sq = MAP_FAILED;
+		void* m_cq = MAP_FAILED;
+		void* m_sqes = MAP_FAILED;
+		size_t m_sqSize = 0, m_cqSize = 0, m_sqesSize = 0;
+		unsigned* m_sqTail = nullptr;
+		unsigned* m_sqMask = nullptr;
+		unsigned* m_sqArray = nullptr;
+		unsigned* m_cqHead = nullptr;
+		unsigned* m_cqTail = nullptr;
+		unsigned* m_cqMask = nullptr;
+		io_uring_cqe* m_cqes = nullptr;
+		std::vector<iovec> m_iov;
+
+		UringQueue() = default;
+
+		inline int Enter(unsigned submit, unsigned wait, unsigned flags) noexcept {
+			int res;
+			do {
+				res = int(syscall(__NR_io_uring_enter, m_fd, submit, wait, flags, nullptr, 0));
+			} while (res < 0 && errno == EINTR);
+			return res;
+		}
+
+		static inline void* Map(int fd, size_t size, uint64_t offset) noexcept {
+			return mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, off_t(offset));
+		}
+
+	public:
+		// nullptr if the kernel doesn't offer io_uring or it is blocked, e.g. by a seccomp filter
+		static inline std::unique_ptr<UringQueue> Open(unsigned entries) {
+			io_uring_params params{};
+			int fd = int(syscall(__NR_io_uring_setup, entries, &params));
+			if (fd < 0)
+				return nullptr;
+			std::unique_ptr<UringQueue> q(new UringQueue());
+			q->m_fd = fd;
+			q->m_sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			q->m_cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+			if (single)
+				q->m_sqSize = q->m_cqSize = std::max(q->m_sqSize, q->m_cqSize);
+			q->m_sq = Map(fd, q->m_sqSize, IORING_OFF_SQ_RING);
+			if (q->m_sq == MAP_FAILED)
+				return nullptr;
+			q->m_cq = single ? q->m_sq : Map(fd, q->m_cqSize, IORING_OFF_CQ_RING);
+			if (q->m_cq == MAP_FAILED)
+				return nullptr;
+			q->m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+			q->m_sqes = Map(fd, q->m_sqesSize, IORING_OFF_SQES);
+			if (q->m_sqes == MAP_FAILED)
+				return nullptr;
+
+			char* sq = (char*)q->m_sq;
+			char* cq = (char*)q->m_cq;
+			q->m_sqTail = (unsigned*)(sq + params.sq_off.tail);
+			q->m_sqMask = (unsigned*)(sq + params.sq_off.ring_mask);
+			q->m_sqArray = (unsigned*)(sq + params.sq_off.array);
+			q->m_cqHead = (unsigned*)(cq + params.cq_off.head);
+			q->m_cqTail = (unsigned*)(cq + params.cq_off.tail);
+			q->m_cqMask = (unsigned*)(cq + params.cq_off.ring_mask);
+			q->m_cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+			q->m_iov.resize(params.sq_entries);
+			return q;
+		}
+
+		UringQueue(const UringQueue&) = delete;
+		UringQueue& operator=(const UringQueue&) = delete;
+
+		inline ~UringQueue() {
+			if (m_sqes != MAP_FAILED)
+				munmap(m_sqes, m_sqesSize);
+			if (m_cq != MAP_FAILED && m_cq != m_sq)
+				munmap(m_cq, m_cqSize);
+			if (m_sq != MAP_FAILED)
+				munmap(m_sq, m_sqSize);
+			if (m_fd >= 0)
+				close(m_fd);
+		}
+
+		// start reading size bytes at offset into buf, tag must be below the number of entries
+		// and not in flight already, false if the read couldn't be submitted
+		inline bool Read(int fd, void* buf, size_t size, uint64_t offset, size_t tag) noexcept {
+			unsigned tail = *m_sqTail;
+			unsigned index = tail & *m_sqMask;
+			io_uring_sqe& sqe = ((io_uring_sqe*)m_sqes)[index];
+			memset(&sqe, 0, sizeof(sqe));
+			m_iov[tag] = { buf, size };
+			sqe.opcode = IORING_OP_READV;
+			sqe.fd = fd;
+			sqe.addr = uint64_t(uintptr_t(&m_iov[tag]));
+			sqe.len = 1;
+			sqe.off = offset;
+			sqe.user_data = tag;
+			m_sqArray[index] = index;
+			__atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+			if (Enter(1, 0, 0) == 1)
+				return true;
+			__atomic_store_n(m_sqTail, tail, __ATOMIC_RELEASE);
+			return false;
+		}
+
+		// wait for at least one read to finish and call done(tag, result) for every finished one,
+		// result is the number of read bytes or -errno, false if waiting failed
+		template<class Func>
+		inline bool Wait(Func&& done) {
+			unsigned head = *m_cqHead;
+			while (head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+				if (Enter(0, 1, IORING_ENTER_GETEVENTS) < 0)
+					return false;
+			}
+			for (unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE); head != tail; ++head) {
+				const io_uring_cqe& cqe = m_cqes[head & *m_cqMask];
+				done(size_t(cqe.user_data), cqe.res);
+			}
+			__atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+			return true;
+		}
+	};
+#endif
+
+	enum class IoBackend { Auto, Threads };
+
+	// block of a file read by ReadFiles(), data points into a buffer that is reused once the next block is requested
+	struct FileBlock
+	{
+		// index of the file in the paths passed to ReadFiles()
+		size_t file;
+		uint64_t offset;
+		Slice<const char> data;
+		// set if the file couldn't be opened or read, data holds what was read before the error
+		std::error_code error;
+	};
+
+	// reads the files block by block with up to depth reads in flight, through io_uring where the kernel
+	// offers it and pread on a thread pool elsewhere, nothing is allocated or started before the first Next()
+	class FileBlockReader
+	{
+		struct Slot
+		{
+			std::unique_ptr<char[]> buf;
+			std::shared_ptr<const ReadOnlyFile> file;
+			size_t index = 0;
+			uint64_t offset = 0;
+			size_t size = 0, done = 0;
+			std::error_code error;
+			bool complete = false;
+		};
+
+		std::vector<std::string> m_paths;
+		size_t m_blockSize, m_depth;
+		IoBackend m_backend;
+
+		// the file that is being split into blocks
+		size_t m_nextIndex = 0, m_index = 0;
+		std::shared_ptr<const ReadOnlyFile> m_file;
+		uint64_t m_nextOffset = 0;
+
+		// blocks in flight are m_slots[m_head], m_slots[m_head + 1], ... in file order
+		std::vector<Slot> m_slots;
+		size_t m_head = 0, m_count = 0;
+		bool m_started = false, m_yielded = false;
+
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+#ifdef ITER_HAS_IO_URING
+		std::unique_ptr<UringQueue> m_uring;
+#endif
+		// declared last so that its workers are done before the slots go away
+		std::unique_ptr<ThreadPool> m_pool;
+
+		// describe the next block in s, false if all files are done
+		inline bool Plan(Slot& s) {
+			while (true) {
+				if (!m_file) {
+					if (m_nextIndex == m_paths.size())
+						return false;
+					m_index = m_nextIndex++;
+					std::error_code err;
+					auto file = std::make_shared<const ReadOnlyFile>(m_paths[m_index], err);
+					if (err) {
+						s.file.reset();
+						s.index = m_index;
+						s.offset = s.size = s.done = 0;
+						s.error = err;
+						s.complete = true;
+						return true;
+					}
+					m_file = std::move(file);
+					m_nextOffset = 0;
+				}
+				if (m_nextOffset >= m_file->Size()) {
+					m_file.reset();
+					continue;
+				}
+				s.file = m_file;
+				s.index = m_index;
+				s.offset = m_nextOffset;
+				s.size = size_t(std::min(uint64_t(m_blockSize), m_file->Size() - m_nextOffset));
+				s.done = 0;
+				s.error = {};
+				s.complete = false;
+				m_nextOffset += s.size;
+				return true;
+			}
+		}
+
+		static inline void ReadRest(Slot& s, std::error_code& err) noexcept {
+			while (s.done < s.size) {
+				size_t read = s.file->ReadAt(s.buf.get() + s.done, s.size - s.done, s.offset + s.done, err);
+				if (read == 0)
+					break;
+				s.done += read;
+			}
+		}
+
+		inline void Start(size_t slot) {
+			Slot& s = m_slots[slot];
+			if (s.complete)
+				return;
+#ifdef ITER_HAS_IO_URING
+			if (m_uring) {
+				if (!m_uring->Read(s.file->Descriptor(), s.buf.get() + s.done, s.size - s.done, s.offset + s.done, slot)) {
+					ReadRest(s, s.error);
+					s.complete = true;
+				}
+				return;
+			}
+#endif
+			m_pool->Submit([this, &s] {
+				std::error_code err;
+				ReadRest(s, err);
+				{
+					std::lock_guard lock(m_mutex);
+					s.error = err;
+					s.complete = true;
+				}
+				m_cv.notify_all();
+			});
+		}
+
+#ifdef ITER_HAS_IO_URING
+		inline void OnRead(size_t slot, int res) {
+			Slot& s = m_slots[slot];
+			if (res < 0)
+				s.error = std::error_code(-res, std::generic_category());
+			else
+				s.done += size_t(res);
+			if (res <= 0 || s.done == s.size)
+				s.complete = true;
+			else
+				Start(slot);
+		}
+#endif
+
+		inline void WaitFor(Slot& s) {
+#ifdef ITER_HAS_IO_URING
+			if (m_uring) {
+				while (!s.complete) {
+					if (!m_uring->Wait([this](size_t slot, int res) { OnRead(slot, res); })) {
+						s.error = std::error_code(errno, std::generic_category());
+						s.complete = true;
+					}
+				}
+				return;
+			}
+#endif
+			std::unique_lock lock(m_mutex);
+			m_cv.wait(lock, [&s] { return s.complete; });
+		}
+
+		// plan and start blocks until depth of them are in flight
+		inline void Fill() {
+			while (m_count < m_depth) {
+				size_t slot = (m_head + m_count) % m_depth;
+				if (!Plan(m_slots[slot]))
+					return;
+				++m_count;
+				Start(slot);
+			}
+		}
+
+		inline void Init() {
+			m_slots.resize(m_depth);
+			for (auto& s : m_slots)
+				s.buf.reset(new char[m_blockSize]);
+#ifdef ITER_HAS_IO_URING
+			if (m_backend == IoBackend::Auto)
+				m_uring = UringQueue::Open(unsigned(m_depth));
+			if (!m_uring)
+				m_pool = std::make_unique<ThreadPool>(m_depth);
+#else
+			m_pool = std::make_unique<ThreadPool>(m_depth);
+#endif
+		}
+
+	public:
+		inline FileBlockReader(std::vector<std::string> paths, size_t blockSize, size_t depth, IoBackend backend)
+			: m_paths(std::move(paths)), m_blockSize(std::max(blockSize, size_t(1))), m_depth(std::max(depth, size_t(1))), m_backend(backend) { }
+
+		FileBlockReader(const FileBlockReader&) = delete;
+		FileBlockReader& operator=(const FileBlockReader&) = delete;
+
+		// the kernel writes into the buffers until the reads finish, so they have to be waited for
+		inline ~FileBlockReader() {
+#ifdef ITER_HAS_IO_URING
+			if (m_uring) {
+				for (size_t i = 0; i < m_count; ++i)
+					WaitFor(m_slots[(m_head + i) % m_depth]);
+			}
+#endif
+		}
+
+		inline Option<FileBlock> Next() {
+			if (!m_started) {
+				m_started = true;
+				Init();
+			}
+			if (m_yielded) {
+				// the consumer is done with the previous block, its buffer takes the next read
+				m_yielded = false;
+				m_head = (m_head + 1) % m_depth;
+				--m_count;
+			}
+			Fill();
+			if (m_count == 0)
+				return {};
+			Slot& s = m_slots[m_head];
+			WaitFor(s);
+			m_yielded = true;
+			return FileBlock{ s.index, s.offset, Slice<const char>(s.buf.get(), s.done), s.error };
+		}
+	};
+
+	// copies of the iterator share the reader, so the blocks should be consumed through one of them
+	struct FileBlocksIterTrait
+	{
+		std::shared_ptr<FileBlockReader> reader;
+		using Type = FileBlock;
+		static inline constexpr bool FastCount = false;
+
+		inline SizeBounds SizeHint() const noexcept {
+			return {};
+		}
+
+		inline Option<Type> Next() {
+			return reader->Next();
+		}
+	};
+
+	// blocks of up to blockSize bytes of each file in order, files that can't be opened yield one block with the error,
+	// depth reads are kept in flight so that the disk works while the blocks are processed
+	inline auto ReadFiles(std::vector<std::string> paths, size_t blockSize = size_t(1) << 20, size_t depth = 8, IoBackend backend = IoBackend::Auto) {
+		auto reader = std::make_shared<FileBlockReader>(std::move(paths), blockSize, depth, backend);
+		return SDIterator(FileBlocksIterTrait{ std::move(reader) });
+	}
+}
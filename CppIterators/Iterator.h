@@ -1,6 +1,14 @@
 #pragma once
+#include <array>
+#include <memory>
 #include "SDIterator.h"
 #include "DDIterator.h"
+#include "Parallel.h"
+#include "Rolling.h"
+#include "Pipeline.h"
+#if __has_include(<span>)
+#include <span>
+#endif
 
 namespace Iter
 {
@@ -11,17 +19,17 @@ namespace Iter
 		using Type = typename Iter::value_type;
 		static inline constexpr bool FastCount = FCount;
 
-		constexpr inline size_t Count() const noexcept {
+		constexpr inline SizeBounds SizeHint() const noexcept {
 			if constexpr (FastCount) {
-				return std::distance(iter, end);
+				return SizeBounds::Exact(size_t(std::distance(iter, end)));
 			}
-			return 0;
+			return {};
 		}
 
 		constexpr inline ForwardIterTrait(Iter b, Iter e)
 			: iter(b), end(e) { }
 
-		constexpr inline std::optional<Type> Next() {
+		constexpr inline Option<Type> Next() {
 			if (iter == end)
 				return {};
 			return Type(*iter++);
@@ -32,20 +40,20 @@ namespace Iter
 	struct ForwardRefIterTrait
 	{
 		Iter iter, end;
-		using Type = Ref<typename Iter::value_type>;
+		using Type = typename Iter::value_type&;
 		static inline constexpr bool FastCount = FCount;
 
-		constexpr inline size_t Count() const noexcept {
+		constexpr inline SizeBounds SizeHint() const noexcept {
 			if constexpr (FastCount) {
-				return std::distance(iter, end);
+				return SizeBounds::Exact(size_t(std::distance(iter, end)));
 			}
-			return 0;
+			return {};
 		}
 
 		constexpr inline ForwardRefIterTrait(Iter b, Iter e)
 			: iter(b), end(e) { }
 
-		constexpr inline std::optional<Type> Next() {
+		constexpr inline Option<Type> Next() {
 			if (iter == end)
 				return {};
 			return Type(*iter++);
@@ -59,26 +67,26 @@ namespace Iter
 		using Type = typename Iter::value_type;
 		static inline constexpr bool FastCount = FCount;
 
-		constexpr inline size_t Count() const noexcept {
+		constexpr inline SizeBounds SizeHint() const noexcept {
 			if constexpr (FastCount) {
-				return std::distance(begin, end);
+				return SizeBounds::Exact(size_t(std::distance(begin, end)));
 			}
-			return 0;
+			return {};
 		}
 
 		constexpr inline DoubleDirIterTrait(Iter b, Iter e)
 			: begin(b), end(e) { }
 
-		constexpr inline std::optional<Type> Next() {
+		constexpr inline Option<Type> Next() {
 			if (begin == end)
 				return {};
 			return Type(*begin++);
 		}
 
-		constexpr inline std::optional<Type> NextBack() {
+		constexpr inline Option<Type> NextBack() {
 			if (begin == end)
 				return {};
-			return Type(*++end);
+			return Type(*--end);
 		}
 	};
 
@@ -86,29 +94,133 @@ namespace Iter
 	struct DoubleDirRefIterTrait
 	{
 		Iter begin, end;
-		using Type = Ref<typename Iter::value_type>;
+		using Type = typename Iter::value_type&;
 		static inline constexpr bool FastCount = FCount;
 
-		constexpr inline size_t Count() const noexcept {
+		constexpr inline SizeBounds SizeHint() const noexcept {
 			if constexpr (FastCount) {
-				return std::distance(begin, end);
+				return SizeBounds::Exact(size_t(std::distance(begin, end)));
 			}
-			return 0;
+			return {};
 		}
 
 		constexpr inline DoubleDirRefIterTrait(Iter b, Iter e)
 			: begin(b), end(e) { }
 
-		constexpr inline std::optional<Type> Next() {
+		constexpr inline Option<Type> Next() {
 			if (begin == end)
 				return {};
 			return Type(*begin++);
 		}
 
-		constexpr inline std::optional<Type> NextBack() {
+		constexpr inline Option<Type> NextBack() {
 			if (begin == end)
 				return {};
-			return Type(*++end);
+			return Type(*--end);
+		}
+	};
+
+	// owns the container and moves the items out of it, copies of the iterator share the container and the
+	// position in it, so every item is moved out once and a second pass over a copy only sees what is left,
+	// the halves made by SplitAt() get positions of their own
+	template<class Cont>
+	struct IntoIterTrait
+	{
+		using It = typename Cont::iterator;
+		static inline constexpr bool RandomAccess = std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category>;
+
+		struct Cursor
+		{
+			It begin, end;
+			size_t left;
+		};
+
+		std::shared_ptr<Cont> cont;
+		std::shared_ptr<Cursor> cur;
+		using Type = typename Cont::value_type;
+		static inline constexpr bool FastCount = true;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return SizeBounds::Exact(cur->left);
+		}
+
+		inline IntoIterTrait(Cont&& c)
+			: cont(std::make_shared<Cont>(std::move(c))),
+			cur(std::make_shared<Cursor>(Cursor{ cont->begin(), cont->end(), size_t(std::distance(cont->begin(), cont->end())) })) { }
+
+		inline IntoIterTrait(std::shared_ptr<Cont> c, std::shared_ptr<Cursor> pos) : cont(std::move(c)), cur(std::move(pos)) { }
+
+		constexpr inline Option<Type> Next() {
+			if (cur->left == 0)
+				return {};
+			--cur->left;
+			return std::move(*cur->begin++);
+		}
+
+		// only for bidirectional containers
+		constexpr inline Option<Type> NextBack() {
+			if (cur->left == 0)
+				return {};
+			--cur->left;
+			return std::move(*--cur->end);
+		}
+
+		template<class U = Cont, std::enable_if_t<IntoIterTrait<U>::RandomAccess, int> = 0>
+		constexpr inline size_t Advance(size_t n) noexcept {
+			n = std::min(n, cur->left);
+			cur->begin += n;
+			cur->left -= n;
+			return n;
+		}
+
+		template<class U = Cont, std::enable_if_t<IntoIterTrait<U>::RandomAccess, int> = 0>
+		constexpr inline size_t AdvanceBack(size_t n) noexcept {
+			n = std::min(n, cur->left);
+			cur->end -= n;
+			cur->left -= n;
+			return n;
+		}
+
+		// keep the first n items, return the rest, both halves share the container
+		template<class U = Cont, std::enable_if_t<IntoIterTrait<U>::RandomAccess, int> = 0>
+		inline IntoIterTrait SplitAt(size_t n) {
+			n = std::min(n, cur->left);
+			It mid = cur->begin + n;
+			IntoIterTrait rest(cont, std::make_shared<Cursor>(Cursor{ mid, cur->end, cur->left - n }));
+			cur->end = mid;
+			cur->left = n;
+			return rest;
+		}
+
+		template<class U = Cont, std::enable_if_t<IntoIterTrait<U>::RandomAccess, int> = 0>
+		inline std::optional<IntoIterTrait> Split() {
+			if (cur->left < 2)
+				return {};
+			return SplitAt(cur->left / 2);
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			auto& c = *cur;
+			for (; c.left != 0; --c.left) {
+				if (!func(acc, Type(std::move(*c.begin++)))) {
+					--c.left;
+					return false;
+				}
+			}
+			return true;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryRFold(Acc& acc, Func&& func) {
+			auto& c = *cur;
+			for (; c.left != 0; --c.left) {
+				if (!func(acc, Type(std::move(*--c.end)))) {
+					--c.left;
+					return false;
+				}
+			}
+			return true;
 		}
 	};
 
@@ -135,4 +247,99 @@ namespace Iter
 		auto trait = DoubleDirRefIterTrait<decltype(list.begin()), true>{ list.begin(), list.end() };
 		return DDIterator(trait);
 	}
+
+	template<class T>
+	constexpr inline auto From(T* data, size_t size) {
+		return DDIterator(ContiguousIterTrait<T>{ data, size });
+	}
+
+	template<class T>
+	constexpr inline auto FromRef(T* data, size_t size) {
+		return DDIterator(ContiguousIterTrait<T, T&>{ data, size });
+	}
+
+	template<class T, size_t N>
+	constexpr inline auto From(T(&arr)[N]) {
+		return From(arr, N);
+	}
+
+	template<class T, size_t N>
+	constexpr inline auto FromRef(T(&arr)[N]) {
+		return FromRef(arr, N);
+	}
+
+	template<class T>
+	constexpr inline auto From(std::vector<T>& vec) {
+		return From(vec.data(), vec.size());
+	}
+
+	template<class T>
+	constexpr inline auto From(const std::vector<T>& vec) {
+		return From(vec.data(), vec.size());
+	}
+
+	template<class T>
+	constexpr inline auto FromRef(std::vector<T>& vec) {
+		return FromRef(vec.data(), vec.size());
+	}
+
+	template<class T>
+	void From(std::vector<T>&&) = delete;
+
+	template<class T, size_t N>
+	constexpr inline auto From(std::array<T, N>& arr) {
+		return From(arr.data(), N);
+	}
+
+	template<class T, size_t N>
+	constexpr inline auto From(const std::array<T, N>& arr) {
+		return From(arr.data(), N);
+	}
+
+	template<class T, size_t N>
+	constexpr inline auto FromRef(std::array<T, N>& arr) {
+		return FromRef(arr.data(), N);
+	}
+
+	template<class T, size_t N>
+	void From(std::array<T, N>&&) = delete;
+
+#ifdef __cpp_lib_span
+	template<class T, size_t E>
+	constexpr inline auto From(std::span<T, E> span) {
+		return From(span.data(), span.size());
+	}
+
+	template<class T, size_t E>
+	constexpr inline auto FromRef(std::span<T, E> span) {
+		return FromRef(span.data(), span.size());
+	}
+#endif
+
+	// move the items out of memory owned by the caller, the items are left moved-from
+	template<class T>
+	constexpr inline auto Drain(T* data, size_t size) {
+		return DDIterator(ContiguousIterTrait<T, T, true>{ data, size });
+	}
+
+	template<class T>
+	constexpr inline auto Drain(std::vector<T>& vec) {
+		return Drain(vec.data(), vec.size());
+	}
+
+	// take the container over and move the items out of it
+	template<class T>
+	inline auto IntoIter(std::vector<T>&& vec) {
+		return DDIterator(IntoIterTrait<std::vector<T>>(std::move(vec)));
+	}
+
+	template<class T>
+	inline auto IntoIter(std::list<T>&& list) {
+		return DDIterator(IntoIterTrait<std::list<T>>(std::move(list)));
+	}
+
+	template<class T>
+	inline auto IntoIter(std::forward_list<T>&& list) {
+		return SDIterator(IntoIterTrait<std::forward_list<T>>(std::move(list)));
+	}
 }
@@ -1,11 +1,22 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
 #include <optional>
+#include <type_traits>
+#include <utility>
 #include <tuple>
 #include <limits>
 #include <stdint.h>
+#include <array>
+#include <iterator>
 #include <forward_list>
 #include <list>
 #include <vector>
+#include <memory_resource>
+#if __has_include(<span>)
+#include <span>
+#endif
+#include "Simd.h"
 
 namespace Iter
 {
@@ -14,56 +25,407 @@ namespace Iter
 	template<class R, R ret, class... Params>
 	constexpr auto DummyFunc = [](Params...) -> R { return ret; };
 
+	// number of items adapters buffer on the stack when they pass blocks through NextBatch()
+	inline constexpr size_t BatchSize = 256;
+
+	// stack bytes one such block may take, blocks of large items are shorter, down to a single item
+	inline constexpr size_t BatchBytes = 4096;
+
+	// block length for items of the given types held side by side
+	template<class... T>
+	inline constexpr size_t BatchSizeOf = std::clamp(BatchBytes / (sizeof(T) + ...), size_t(1), BatchSize);
+
+	// optional reference, std::optional can't hold one, assigning rebinds it like a pointer
 	template<class T>
-	class Ref
+	class OptionalRef
 	{
-		T* m_value;
+		T* m_value = nullptr;
 	public:
-		Ref() : m_value(nullptr) {}
+		constexpr OptionalRef() noexcept = default;
 
-		Ref(T& val) : m_value(&val) {}
+		constexpr OptionalRef(std::nullopt_t) noexcept { }
 
-		Ref& operator=(const T& val) {
-			*m_value = val;
-			return *this;
+		constexpr OptionalRef(T& val) noexcept : m_value(&val) { }
+
+		template<class U, std::enable_if_t<std::is_convertible_v<U*, T*>, int> = 0>
+		constexpr OptionalRef(OptionalRef<U> other) noexcept : m_value(other ? &*other : nullptr) { }
+
+		constexpr bool has_value() const noexcept {
+			return m_value != nullptr;
+		}
+
+		constexpr explicit operator bool() const noexcept {
+			return m_value != nullptr;
 		}
 
-		operator T&() {
+		constexpr T& operator*() const noexcept {
 			return *m_value;
 		}
+
+		constexpr T* operator->() const noexcept {
+			return m_value;
+		}
+
+		constexpr T& value() const {
+			if (!m_value)
+				throw std::bad_optional_access();
+			return *m_value;
+		}
+
+		constexpr T& emplace(T& val) noexcept {
+			m_value = &val;
+			return val;
+		}
+
+		constexpr void reset() noexcept {
+			m_value = nullptr;
+		}
+
+		template<class U>
+		constexpr std::remove_cv_t<T> value_or(U&& other) const {
+			return m_value ? *m_value : std::remove_cv_t<T>(std::forward<U>(other));
+		}
+	};
+
+	// what Next() returns, items of reference type are passed on without copying
+	template<class T>
+	using Option = std::conditional_t<std::is_reference_v<T>, OptionalRef<std::remove_reference_t<T>>, std::optional<T>>;
+
+	// type to store items in, references are stored as copies
+	template<class T>
+	using ValueOf = std::remove_cv_t<std::remove_reference_t<T>>;
+
+	// non-owning view of size items starting at data
+	template<class T>
+	class Slice
+	{
+		T* m_data;
+		size_t m_size;
+
+	public:
+		using value_type = std::remove_cv_t<T>;
+
+		inline constexpr Slice() noexcept : m_data(nullptr), m_size(0) { }
+
+		inline constexpr Slice(T* data, size_t size) noexcept : m_data(data), m_size(size) { }
+
+		inline constexpr T* data() const noexcept { return m_data; }
+		inline constexpr size_t size() const noexcept { return m_size; }
+		inline constexpr bool empty() const noexcept { return m_size == 0; }
+		inline constexpr T* begin() const noexcept { return m_data; }
+		inline constexpr T* end() const noexcept { return m_data + m_size; }
+		inline constexpr T& operator[](size_t i) const noexcept { return m_data[i]; }
+
+		inline constexpr Slice First(size_t n) const noexcept {
+			return { m_data, std::min(n, m_size) };
+		}
+
+#ifdef __cpp_lib_span
+		inline constexpr operator std::span<T>() const noexcept {
+			return { m_data, m_size };
+		}
+#endif
+	};
+
+	// lower and, if known, upper bound on the number of remaining items
+	struct SizeBounds
+	{
+		size_t lower = 0;
+		std::optional<size_t> upper;
+
+		static inline constexpr SizeBounds Exact(size_t n) noexcept {
+			return { n, n };
+		}
+
+		inline constexpr bool IsExact() const noexcept {
+			return upper && *upper == lower;
+		}
+
+		inline constexpr SizeBounds Min(SizeBounds other) const noexcept {
+			SizeBounds res{ std::min(lower, other.lower), upper };
+			if (!upper || (other.upper && *other.upper < *upper))
+				res.upper = other.upper;
+			return res;
+		}
+
+		inline constexpr SizeBounds Min(size_t n) const noexcept {
+			return Min(Exact(n));
+		}
+
+		inline constexpr SizeBounds Add(SizeBounds other) const noexcept {
+			size_t sum = lower + other.lower;
+			SizeBounds res{ sum < lower ? size_t(-1) : sum, {} };
+			if (upper && other.upper && *upper + *other.upper >= *upper)
+				res.upper = *upper + *other.upper;
+			return res;
+		}
+
+		// bounds of every n-th item, starting with the first one
+		inline constexpr SizeBounds Step(size_t n) const noexcept {
+			auto ceilDiv = [n](size_t x) { return x / n + (x % n != 0); };
+			SizeBounds res{ ceilDiv(lower), {} };
+			if (upper)
+				res.upper = ceilDiv(*upper);
+			return res;
+		}
+
+		// bounds of the number of whole chunks of n items
+		inline constexpr SizeBounds Chunks(size_t n) const noexcept {
+			SizeBounds res{ lower / n, {} };
+			if (upper)
+				res.upper = *upper / n;
+			return res;
+		}
+
+		// bounds of the number of windows of n consecutive items
+		inline constexpr SizeBounds Windows(size_t n) const noexcept {
+			auto windows = [n](size_t x) { return x < n ? 0 : x - n + 1; };
+			SizeBounds res{ windows(lower), {} };
+			if (upper)
+				res.upper = windows(*upper);
+			return res;
+		}
 	};
 
+	// count items first, first + step, first + 2 * step, ... of an integral type, lets reductions over ranges
+	// run in O(1), the arithmetic is done on 64 bit unsigned integers so that it wraps like the item type
+	template<class T>
+	struct Progression
+	{
+		static_assert(std::is_integral_v<T> && sizeof(T) <= sizeof(uint64_t));
+
+		T first;
+		uint64_t step;
+		size_t count;
+
+		inline constexpr T At(size_t i) const noexcept {
+			return T(uint64_t(first) + step * uint64_t(i));
+		}
+
+		inline constexpr T Last() const noexcept {
+			return At(count - 1);
+		}
+
+		inline constexpr Progression Skip(size_t n) const noexcept {
+			n = std::min(n, count);
+			return { At(n), step, count - n };
+		}
+
+		inline constexpr Progression Take(size_t n) const noexcept {
+			return { first, step, std::min(n, count) };
+		}
+
+		// every n-th item, starting with the first one
+		inline constexpr Progression Step(size_t n) const noexcept {
+			return { first, step * uint64_t(n), count / n + (count % n != 0) };
+		}
+
+		inline constexpr Progression Reverse() const noexcept {
+			if (count == 0)
+				return *this;
+			return { Last(), uint64_t(0) - step, count };
+		}
+
+		inline constexpr T Sum() const noexcept {
+			// count * (count - 1) / 2 without losing the top bit, one of the factors is even
+			uint64_t a = count, b = uint64_t(count) - 1;
+			(a % 2 == 0 ? a : b) /= 2;
+			return T(uint64_t(first) * count + step * (a * b));
+		}
+
+		// the items are monotonic, so the extremes are the ends, count must not be 0
+		inline constexpr T Min() const noexcept {
+			return std::min(first, Last());
+		}
+
+		inline constexpr T Max() const noexcept {
+			return std::max(first, Last());
+		}
+
+		inline constexpr bool ContainsZero() const noexcept {
+			if (count == 0 || Min() > T(0) || Max() < T(0))
+				return false;
+			uint64_t stride = std::min(step, uint64_t(0) - step);
+			uint64_t dist = uint64_t(0) - uint64_t(Min());
+			return stride == 0 || dist % stride == 0;
+		}
+
+		// nullopt if there is no shortcut and the items have to be multiplied one by one
+		inline constexpr std::optional<T> Product() const noexcept {
+			if (count == 0)
+				return T(1);
+			if (ContainsZero())
+				return T(0);
+			if (step == 0) {
+				// count times the same item, square and multiply
+				uint64_t res = 1, base = uint64_t(first);
+				for (size_t n = count; n != 0; n /= 2, base *= base) {
+					if (n % 2 != 0)
+						res *= base;
+				}
+				return T(res);
+			}
+			// every even item adds a factor of 2, with as many of them as T has bits the product wraps to 0
+			size_t evens = first % 2 != 0 ? (step % 2 != 0 ? count / 2 : 0) : (step % 2 != 0 ? (count + 1) / 2 : count);
+			if (evens >= sizeof(T) * 8)
+				return T(0);
+			return {};
+		}
+	};
+
+	template<class Trait, class = void>
+	struct HasAdvance : std::false_type { };
+
+	template<class Trait>
+	struct HasAdvance<Trait, std::void_t<decltype(std::declval<Trait&>().Advance(size_t()))>> : std::true_type { };
+
+	template<class Trait, class = void>
+	struct HasAdvanceBack : std::false_type { };
+
+	template<class Trait>
+	struct HasAdvanceBack<Trait, std::void_t<decltype(std::declval<Trait&>().AdvanceBack(size_t()))>> : std::true_type { };
+
+	template<class Trait, class = void>
+	struct HasTryFold : std::false_type { };
+
+	template<class Trait>
+	struct HasTryFold<Trait, std::void_t<decltype(std::declval<Trait&>().TryFold(
+		std::declval<size_t&>(), std::declval<bool(&)(size_t&, typename Trait::Type&)>()))>> : std::true_type { };
+
+	template<class Trait, class = void>
+	struct HasTryRFold : std::false_type { };
+
+	template<class Trait>
+	struct HasTryRFold<Trait, std::void_t<decltype(std::declval<Trait&>().TryRFold(
+		std::declval<size_t&>(), std::declval<bool(&)(size_t&, typename Trait::Type&)>()))>> : std::true_type { };
+
+	template<class Trait, class = void>
+	struct HasNextBatch : std::false_type { };
+
+	template<class Trait>
+	struct HasNextBatch<Trait, std::void_t<decltype(std::declval<Trait&>().NextBatch((ValueOf<typename Trait::Type>*)nullptr, size_t()))>> : std::true_type { };
+
+	template<class Trait, class = void>
+	struct HasSplit : std::false_type { };
+
+	template<class Trait>
+	struct HasSplit<Trait, std::void_t<decltype(std::declval<Trait&>().Split())>> : std::true_type { };
+
+	template<class Trait, class = void>
+	struct HasSplitAt : std::false_type { };
+
+	template<class Trait>
+	struct HasSplitAt<Trait, std::void_t<decltype(std::declval<Trait&>().SplitAt(size_t()))>> : std::true_type { };
+
+	template<class Trait, class = void>
+	struct HasAsSlice : std::false_type { };
+
+	template<class Trait>
+	struct HasAsSlice<Trait, std::void_t<decltype(std::declval<const Trait&>().AsSlice())>> : std::true_type { };
+
+	template<class Trait, class = void>
+	struct HasAsProgression : std::false_type { };
+
+	template<class Trait>
+	struct HasAsProgression<Trait, std::void_t<decltype(std::declval<const Trait&>().AsProgression())>> : std::true_type { };
+
+	template<class Trait, class = void>
+	struct HasAsProgressionBack : std::false_type { };
+
+	template<class Trait>
+	struct HasAsProgressionBack<Trait, std::void_t<decltype(std::declval<const Trait&>().AsProgressionBack())>> : std::true_type { };
+
+	template<class Cont, class = void>
+	struct HasReserve : std::false_type { };
+
+	template<class Cont>
+	struct HasReserve<Cont, std::void_t<decltype(std::declval<Cont&>().reserve(size_t()))>> : std::true_type { };
+
+	template<class Iter, class Cont>
+	inline constexpr void CollectImpl(Iter it, Cont& cont) {
+		if constexpr (HasReserve<Cont>::value) {
+			cont.reserve(cont.size() + it.SizeHint().lower);
+		}
+		if constexpr (Iter::FastBatch && std::is_arithmetic_v<typename Iter::Type>) {
+			// lets adapters like Filter work a block at a time
+			typename Iter::Type buf[BatchSize];
+			size_t m;
+			do {
+				m = it.NextBatch(buf, BatchSize);
+				for (size_t i = 0; i < m; ++i)
+					cont.push_back(buf[i]);
+			} while (m == BatchSize);
+			return;
+		}
+		it.TryFold(cont, [](Cont& c, auto&& v) {
+			c.push_back(std::forward<decltype(v)>(v));
+			return true;
+		});
+	}
+
+	template<class Iter, class Out>
+	inline constexpr size_t CollectIntoImpl(Iter it, Out* data, size_t size) {
+		if constexpr (Iter::FastBatch && std::is_same_v<Out, typename Iter::Type>) {
+			return it.NextBatch(data, size);
+		}
+		size_t i = 0;
+		if (size == 0)
+			return i;
+		it.TryFold(i, [data, size](size_t& i, auto&& v) {
+			data[i++] = std::forward<decltype(v)>(v);
+			return i < size;
+		});
+		return i;
+	}
+
+	// reduce the items block by block with the SIMD kernels, nullopt if the iterator is empty
+	template<Simd::Reduction op, class Iter, class T = typename Iter::Type>
+	inline std::optional<T> BatchReduceImpl(Iter it) {
+		T buf[BatchSize];
+		size_t m = it.NextBatch(buf, BatchSize);
+		if (m == 0)
+			return {};
+		T acc = Simd::Reduce<op>(buf + 1, m - 1, buf[0]);
+		while (m == BatchSize && (m = it.NextBatch(buf, BatchSize)) > 0)
+			acc = Simd::Reduce<op>(buf, m, acc);
+		return acc;
+	}
+
+	// end marker of range-for loops, the loop stops when the iterator runs out of items
+	struct RangeForEnd { };
+
 	template<class Iter>
 	class RangeForIter
 	{
 		using Type = typename Iter::Type;
 
 		Iter m_iter;
-		std::optional<Type> m_curr;
-		bool m_valid;
+		Option<Type> m_curr;
 
 	public:
-		inline constexpr RangeForIter(Iter it, bool valid = true)
-			: m_iter(it), m_valid(valid)
+		inline constexpr RangeForIter(Iter it)
+			: m_iter(it)
 		{
 			operator++();
 		}
 
 		inline constexpr auto& operator++() {
+			// assigning to an engaged optional would write through the references of a tuple item
+			m_curr.reset();
 			m_curr = m_iter.Next();
 			return *this;
 		}
 
-		inline constexpr Type operator*() {
-			return m_curr.value();
+		inline constexpr Type& operator*() {
+			return *m_curr;
 		}
 
-		inline constexpr bool Valid() {
-			return m_curr && m_valid;
+		inline constexpr bool operator!=(RangeForEnd) const noexcept {
+			return m_curr.has_value();
 		}
 
-		inline constexpr bool operator!=(RangeForIter other) {
-			return other.Valid() != Valid();
+		inline constexpr bool operator==(RangeForEnd) const noexcept {
+			return !m_curr.has_value();
 		}
 	};
 }
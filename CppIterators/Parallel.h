@@ -0,0 +1,517 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "SDIterator.h"
+#include "DDIterator.h"
+
+namespace Iter
+{
+	class ThreadPool
+	{
+		std::vector<std::thread> m_threads;
+		std::deque<std::function<void()>> m_tasks;
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		bool m_stop = false;
+
+		inline void Worker() {
+			while (true) {
+				std::function<void()> task;
+				{
+					std::unique_lock lock(m_mutex);
+					m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+					if (m_tasks.empty())
+						return;
+					task = std::move(m_tasks.front());
+					m_tasks.pop_front();
+				}
+				task();
+			}
+		}
+
+	public:
+		inline explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+			m_threads.reserve(threads);
+			for (size_t i = 0; i < threads; ++i)
+				m_threads.emplace_back([this] { Worker(); });
+		}
+
+		inline ~ThreadPool() {
+			{
+				std::lock_guard lock(m_mutex);
+				m_stop = true;
+			}
+			m_cv.notify_all();
+			for (auto& t : m_threads)
+				t.join();
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		inline size_t Size() const noexcept {
+			return m_threads.size();
+		}
+
+		inline void Submit(std::function<void()> task) {
+			{
+				std::lock_guard lock(m_mutex);
+				m_tasks.push_back(std::move(task));
+			}
+			m_cv.notify_one();
+		}
+
+		// call func(i) for every i in [0; n) on the pool, the calling thread takes part too,
+		// so nested calls from inside a task can't deadlock
+		template<class Func>
+		inline void ForEachIndex(size_t n, Func&& func) {
+			struct State
+			{
+				std::atomic<size_t> next{ 0 };
+				std::atomic<size_t> done{ 0 };
+				std::mutex mutex;
+				std::condition_variable cv;
+			};
+
+			if (n == 0)
+				return;
+			auto state = std::make_shared<State>();
+			auto* f = &func;
+			auto run = [state, f, n] {
+				for (size_t i; (i = state->next++) < n;) {
+					(*f)(i);
+					if (++state->done == n) {
+						std::lock_guard lock(state->mutex);
+						state->cv.notify_all();
+					}
+				}
+			};
+
+			size_t helpers = std::min(n, Size() + 1) - 1;
+			for (size_t i = 0; i < helpers; ++i)
+				Submit(run);
+			run();
+
+			std::unique_lock lock(state->mutex);
+			state->cv.wait(lock, [&] { return state->done == n; });
+		}
+
+		static inline ThreadPool& Global() {
+			static ThreadPool pool;
+			return pool;
+		}
+	};
+
+	/*
+	 * Recursive decomposition of an iterator with Split() over work-stealing deques.
+	 * Each worker splits its piece while the split budget lasts, keeps working on the front part
+	 * and pushes the back part to its own deque. Idle workers steal the oldest (biggest) piece
+	 * of another worker and get a fresh budget, so pieces only get smaller where work is uneven.
+	 * Calls leaf(key, piece) for every piece and returns the results in iterator order,
+	 * with an exact count the key is the position of the first item of the piece.
+	 */
+	template<class Iter, class Leaf>
+	inline auto ForEachSplit(Iter it, size_t minChunk, Leaf&& leaf) {
+		using Ret = decltype(leaf(size_t(), it));
+		struct Task
+		{
+			Iter it;
+			size_t lo, hi;
+			size_t splits;
+		};
+		struct Worker
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+			std::vector<std::pair<size_t, Ret>> results;
+		};
+
+		auto& pool = ThreadPool::Global();
+		size_t workers = pool.Size() + 1;
+		std::vector<Worker> state(workers);
+		std::atomic<size_t> pending{ 1 };
+		// idle workers sleep until a piece is pushed or the last one is done,
+		// pushes counts the pushed pieces so that one pushed during a search isn't missed
+		std::mutex idleMutex;
+		std::condition_variable idleCv;
+		std::atomic<size_t> pushes{ 0 };
+		state[0].tasks.push_back({ it, 0, Iter::FastCount ? it.Count() : std::numeric_limits<size_t>::max(), workers });
+
+		pool.ForEachIndex(workers, [&](size_t self) {
+			auto& own = state[self];
+			while (pending > 0) {
+				size_t seen = pushes;
+				std::optional<Task> task;
+				{
+					std::lock_guard lock(own.mutex);
+					if (!own.tasks.empty()) {
+						task.emplace(std::move(own.tasks.back()));
+						own.tasks.pop_back();
+					}
+				}
+				for (size_t i = 1; !task && i < workers; ++i) {
+					auto& victim = state[(self + i) % workers];
+					std::lock_guard lock(victim.mutex);
+					if (!victim.tasks.empty()) {
+						task.emplace(std::move(victim.tasks.front()));
+						victim.tasks.pop_front();
+						task->splits = std::max(task->splits, workers);
+					}
+				}
+				if (!task) {
+					std::unique_lock lock(idleMutex);
+					idleCv.wait(lock, [&] { return pending == 0 || pushes != seen; });
+					continue;
+				}
+
+				while (task->splits > 0 && task->hi - task->lo > 1) {
+					auto upper = task->it.SizeHint().upper;
+					if (upper && *upper <= minChunk)
+						break;
+					auto rest = task->it.Split();
+					if (!rest)
+						break;
+					task->splits /= 2;
+					size_t mid = Iter::FastCount ? task->lo + task->it.Count() : task->lo + (task->hi - task->lo) / 2;
+					++pending;
+					{
+						std::lock_guard lock(own.mutex);
+						own.tasks.push_back({ *rest, mid, task->hi, task->splits });
+					}
+					task->hi = mid;
+					{
+						std::lock_guard lock(idleMutex);
+						++pushes;
+					}
+					idleCv.notify_one();
+				}
+
+				auto res = leaf(task->lo, task->it);
+				{
+					std::lock_guard lock(own.mutex);
+					own.results.emplace_back(task->lo, std::move(res));
+				}
+				if (--pending == 0) {
+					std::lock_guard lock(idleMutex);
+					idleCv.notify_all();
+				}
+			}
+		});
+
+		std::vector<std::pair<size_t, Ret>*> order;
+		for (auto& w : state) {
+			for (auto& r : w.results)
+				order.push_back(&r);
+		}
+		std::sort(order.begin(), order.end(), [](auto* l, auto* r) { return l->first < r->first; });
+		std::vector<Ret> res;
+		res.reserve(order.size());
+		for (auto* r : order)
+			res.push_back(std::move(r->second));
+		return res;
+	}
+
+	// sum of the partial results of run(leaf), pieces of a filtered iterator may turn out empty, 0 if all are
+	template<class Ret, class Run>
+	inline Ret ParSum(Run&& run) {
+		auto partial = run([](size_t, auto it) -> std::optional<Ret> {
+			if constexpr (decltype(it)::FastCount) {
+				if (it.Count() == 0)
+					return {};
+				return it.Sum();
+			} else {
+				auto first = it.Next();
+				if (!first)
+					return {};
+				return it.Fold(Ret(*first), [](auto a, auto b) { return a + b; });
+			}
+		});
+		std::optional<Ret> res;
+		for (auto& part : partial) {
+			if (part)
+				res = res ? Ret(*res + *part) : *part;
+		}
+		return res.value_or(Ret(0));
+	}
+
+	// concatenate the per piece vectors returned by run(leaf)
+	template<class Cont, class Run>
+	inline Cont ParCollect(Run&& run) {
+		auto partial = run([](size_t, auto it) {
+			return it.ToVector();
+		});
+		Cont cont{};
+		if constexpr (HasReserve<Cont>::value) {
+			size_t count = 0;
+			for (auto& part : partial)
+				count += part.size();
+			cont.reserve(count);
+		}
+		for (auto& part : partial) {
+			for (auto& v : part)
+				cont.push_back(std::move(v));
+		}
+		return cont;
+	}
+
+	/*
+	 * Parallel view of an iterator, the work runs on ThreadPool::Global().
+	 * Iterators with Split() are decomposed adaptively by ForEachSplit(),
+	 * others must have exact count and O(1) Advance and are split into equal contiguous index ranges.
+	 * Results are combined in iterator order, so they don't depend on scheduling.
+	 */
+	template<class Iter>
+	class ParIterator
+	{
+		static_assert(Iter::FastSplit || (Iter::FastCount && Iter::FastAdvance), "Par() needs Split() or an exact count and O(1) Advance");
+
+		Iter m_iter;
+		size_t m_minChunk;
+
+	public:
+		using Type = typename Iter::Type;
+
+		inline ParIterator(Iter it, size_t minChunk) noexcept
+			: m_iter(it), m_minChunk(std::max(minChunk, size_t(1))) { }
+
+		// number of index ranges to split count items into
+		inline size_t ChunkCount(size_t count) const noexcept {
+			size_t maxChunks = (ThreadPool::Global().Size() + 1) * 4;
+			return std::max(size_t(1), std::min(count / m_minChunk, maxChunks));
+		}
+
+		// call leaf(position of the first item, iterator over the piece) for every piece in parallel,
+		// return the results in iterator order
+		template<class Leaf>
+		inline auto Run(Leaf&& leaf) const {
+			if constexpr (Iter::FastSplit) {
+				return ForEachSplit(m_iter, m_minChunk, leaf);
+			} else {
+				using Ret = decltype(leaf(size_t(), m_iter.Take(0)));
+				size_t count = m_iter.Count();
+				size_t chunks = ChunkCount(count);
+				std::vector<std::optional<Ret>> partial(chunks);
+				ThreadPool::Global().ForEachIndex(chunks, [&](size_t i) {
+					size_t begin = count / chunks * i + std::min(i, count % chunks);
+					size_t len = count / chunks + (i < count % chunks);
+					partial[i] = leaf(begin, m_iter.Skip(begin).Take(len));
+				});
+				std::vector<Ret> res;
+				res.reserve(chunks);
+				for (auto& part : partial)
+					res.push_back(std::move(*part));
+				return res;
+			}
+		}
+
+		// fold every piece starting with init, then combine the partial results left to right
+		template<class Ret, class Func, class Combine>
+		inline Ret Fold(Ret init, Func func, Combine combine) const {
+			auto partial = Run([&](size_t, auto it) {
+				return it.Fold(init, func);
+			});
+			Ret res = std::move(partial[0]);
+			for (size_t i = 1; i < partial.size(); ++i)
+				res = combine(res, partial[i]);
+			return res;
+		}
+
+		inline auto Sum() const {
+			return ParSum<decltype(m_iter.Sum())>([this](auto&& leaf) { return Run(leaf); });
+		}
+
+		inline size_t Count() const noexcept {
+			if constexpr (Iter::FastCount) {
+				return m_iter.Count();
+			}
+			size_t res = 0;
+			for (size_t part : Run([](size_t, auto it) { return it.Count(); }))
+				res += part;
+			return res;
+		}
+
+		// func must be safe to call from several threads at once
+		template<class Func>
+		inline void ForEach(Func func) const {
+			Run([&](size_t, auto it) {
+				it.ForEach(func);
+				return true;
+			});
+		}
+
+		template<class Cont>
+		inline Cont Collect() const {
+			return ParCollect<Cont>([this](auto&& leaf) { return Run(leaf); });
+		}
+
+		inline std::vector<ValueOf<Type>> ToVector() const {
+			if constexpr (Iter::FastCount && std::is_default_constructible_v<ValueOf<Type>>) {
+				// every piece writes straight into its own part of the result
+				std::vector<ValueOf<Type>> res(m_iter.Count());
+				Run([&](size_t begin, auto it) {
+					it.CollectInto(res.data() + begin, res.size() - begin);
+					return true;
+				});
+				return res;
+			}
+			return Collect<std::vector<ValueOf<Type>>>();
+		}
+	};
+
+	/*
+	 * Parallel consumer of a source that can only be read in order (e.g. std::list).
+	 * Workers take turns to claim the next batch of up to batch items from the shared source,
+	 * then run the downstream Map/Filter stages and the reduction on their batch in parallel.
+	 * Batches are numbered when claimed, so results are combined in source order.
+	 */
+	template<class Iter, class Stages>
+	class ParBridgeIterator
+	{
+		Iter m_iter;
+		Stages m_stages;
+		size_t m_batch;
+
+		template<class Func>
+		inline auto Then(Func func) const noexcept {
+			auto stages = m_stages;
+			auto next = [stages, func](auto it) { return func(stages(it)); };
+			return ParBridgeIterator<Iter, decltype(next)>(m_iter, next, m_batch);
+		}
+
+	public:
+		using Source = ValueOf<typename Iter::Type>;
+		using Batch = DDIterator<ContiguousIterTrait<Source, Source, true>>;
+		using Downstream = decltype(std::declval<const Stages&>()(std::declval<Batch>()));
+		using Type = typename Downstream::Type;
+
+		inline ParBridgeIterator(Iter it, Stages stages, size_t batch) noexcept
+			: m_iter(it), m_stages(stages), m_batch(std::max(batch, size_t(1))) { }
+
+		template<class Func>
+		inline auto Map(Func func) const noexcept {
+			return Then([func](auto it) { return it.Map(func); });
+		}
+
+		template<class Func>
+		inline auto Filter(Func func) const noexcept {
+			return Then([func](auto it) { return it.Filter(func); });
+		}
+
+		// call leaf(batch number, downstream iterator over the batch) for every batch in parallel,
+		// return the results in source order
+		template<class Leaf>
+		inline auto Run(Leaf&& leaf) const {
+			using Ret = decltype(leaf(size_t(), std::declval<Downstream>()));
+
+			auto& pool = ThreadPool::Global();
+			std::mutex mutex;
+			Iter source = m_iter;
+			bool done = false;
+			size_t claimed = 0;
+			std::vector<std::pair<size_t, Ret>> results;
+
+			pool.ForEachIndex(pool.Size() + 1, [&](size_t) {
+				std::vector<Source> batch;
+				batch.reserve(m_batch);
+				while (true) {
+					size_t seq;
+					{
+						std::lock_guard lock(mutex);
+						if (done)
+							return;
+						seq = claimed++;
+						batch.clear();
+						source.TryFold(batch, [this](auto& b, auto&& v) {
+							b.push_back(std::forward<decltype(v)>(v));
+							return b.size() < m_batch;
+						});
+						done = batch.size() < m_batch;
+					}
+					if (batch.empty())
+						return;
+					auto res = leaf(seq, m_stages(Batch(ContiguousIterTrait<Source, Source, true>(batch.data(), batch.size()))));
+					std::lock_guard lock(mutex);
+					results.emplace_back(seq, std::move(res));
+				}
+			});
+
+			std::sort(results.begin(), results.end(), [](auto& l, auto& r) { return l.first < r.first; });
+			std::vector<Ret> res;
+			res.reserve(results.size());
+			for (auto& r : results)
+				res.push_back(std::move(r.second));
+			return res;
+		}
+
+		// fold every batch starting with init, then combine the partial results left to right
+		template<class Ret, class Func, class Combine>
+		inline Ret Fold(Ret init, Func func, Combine combine) const {
+			auto partial = Run([&](size_t, auto it) {
+				return it.Fold(init, func);
+			});
+			if (partial.empty())
+				return init;
+			Ret res = std::move(partial[0]);
+			for (size_t i = 1; i < partial.size(); ++i)
+				res = combine(res, partial[i]);
+			return res;
+		}
+
+		inline auto Sum() const {
+			return ParSum<decltype(std::declval<Downstream>().Sum())>([this](auto&& leaf) { return Run(leaf); });
+		}
+
+		inline size_t Count() const {
+			size_t res = 0;
+			for (size_t part : Run([](size_t, auto it) { return it.Count(); }))
+				res += part;
+			return res;
+		}
+
+		// func must be safe to call from several threads at once
+		template<class Func>
+		inline void ForEach(Func func) const {
+			Run([&](size_t, auto it) {
+				it.ForEach(func);
+				return true;
+			});
+		}
+
+		template<class Cont>
+		inline Cont Collect() const {
+			return ParCollect<Cont>([this](auto&& leaf) { return Run(leaf); });
+		}
+
+		inline std::vector<ValueOf<Type>> ToVector() const {
+			return Collect<std::vector<ValueOf<Type>>>();
+		}
+	};
+
+	template<class SDTrait>
+	inline auto SDIterator<SDTrait>::Par(size_t minChunk) const noexcept {
+		return ParIterator<SDIterator<SDTrait>>(*this, minChunk);
+	}
+
+	template<class DDTrait>
+	inline auto DDIterator<DDTrait>::Par(size_t minChunk) const noexcept {
+		return ParIterator<DDIterator<DDTrait>>(*this, minChunk);
+	}
+
+	template<class SDTrait>
+	inline auto SDIterator<SDTrait>::ParBridge(size_t batch) const noexcept {
+		auto stages = [](auto it) { return it; };
+		return ParBridgeIterator<SDIterator<SDTrait>, decltype(stages)>(*this, stages, batch);
+	}
+
+	template<class DDTrait>
+	inline auto DDIterator<DDTrait>::ParBridge(size_t batch) const noexcept {
+		auto stages = [](auto it) { return it; };
+		return ParBridgeIterator<DDIterator<DDTrait>, decltype(stages)>(*this, stages, batch);
+	}
+}
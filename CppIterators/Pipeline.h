@@ -0,0 +1,307 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "SDIterator.h"
+#include "DDIterator.h"
+
+namespace Iter
+{
+	// lets a thread sleep until another one makes a condition true, notifying costs a fence and an atomic load
+	// unless the other thread is actually asleep
+	class Parker
+	{
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::atomic<bool> m_sleeping{ false };
+
+	public:
+		template<class Pred>
+		inline void Wait(Pred&& pred) {
+			for (int i = 0; i < 64; ++i) {
+				if (pred())
+					return;
+				std::this_thread::yield();
+			}
+			std::unique_lock lock(m_mutex);
+			m_sleeping.store(true);
+			// pairs with the fence in Notify(), either pred() sees the change or Notify() sees m_sleeping
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			while (!pred())
+				m_cv.wait(lock);
+			m_sleeping.store(false, std::memory_order_relaxed);
+		}
+
+		// call after making the condition true
+		inline void Notify() {
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (m_sleeping.load(std::memory_order_relaxed)) {
+				std::lock_guard lock(m_mutex);
+				m_cv.notify_one();
+			}
+		}
+	};
+
+	// the indices of an SpscRing, which is all that's needed to watch how full it is
+	class SpscRingBase
+	{
+	protected:
+		size_t m_mask = 0;
+		alignas(64) std::atomic<size_t> m_head{ 0 };
+		alignas(64) std::atomic<size_t> m_tail{ 0 };
+
+	public:
+		inline size_t Size() const noexcept {
+			return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+		}
+
+		inline size_t Capacity() const noexcept {
+			return m_mask + 1;
+		}
+	};
+
+	// bounded lock-free queue of Option items for one producer and one consumer thread,
+	// the capacity is rounded up to a power of 2
+	template<class T>
+	class SpscRing : public SpscRingBase
+	{
+		std::vector<T> m_slots;
+
+		// assigning to an engaged optional would write through the references of a tuple item,
+		// items that can't be assigned at all are constructed in place
+		static inline void Move(T& to, T& from) {
+			to.reset();
+			if constexpr (std::is_move_assignable_v<T>) {
+				to = std::move(from);
+			}
+			else {
+				to.emplace(std::move(*from));
+			}
+		}
+
+	public:
+		inline explicit SpscRing(size_t capacity) {
+			size_t size = 1;
+			while (size < capacity)
+				size *= 2;
+			m_slots.resize(size);
+			m_mask = size - 1;
+		}
+
+		// move v in unless the ring is full, only called by the producer
+		inline bool TryPush(T& v) {
+			size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+				return false;
+			Move(m_slots[tail & m_mask], v);
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// move the oldest item to out unless the ring is empty, only called by the consumer
+		inline bool TryPop(T& out) {
+			size_t head = m_head.load(std::memory_order_relaxed);
+			if (head == m_tail.load(std::memory_order_acquire))
+				return false;
+			auto& slot = m_slots[head & m_mask];
+			Move(out, slot);
+			slot.reset();
+			m_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+	};
+
+	// snapshot of the queue at the end of one stage, a stage whose input queue stays full
+	// while its output queue stays empty is the bottleneck of the pipeline
+	struct StageStats
+	{
+		size_t queued;
+		size_t capacity;
+		// times the stage found its output queue full and had to wait for the next stage
+		size_t producerWaits;
+		// times the next stage found the queue empty and had to wait for this one
+		size_t consumerWaits;
+	};
+
+	// the part of a stage Stages() can see without knowing the iterator it runs
+	class PipelineStage
+	{
+	protected:
+		const SpscRingBase& m_queue;
+		// every stage before this one, the first one first
+		std::vector<std::shared_ptr<const PipelineStage>> m_upstream;
+		std::atomic<size_t> m_producerWaits{ 0 }, m_consumerWaits{ 0 };
+
+		inline PipelineStage(const SpscRingBase& queue, std::vector<std::shared_ptr<const PipelineStage>> upstream) noexcept
+			: m_queue(queue), m_upstream(std::move(upstream)) { }
+
+	public:
+		inline StageStats Stats() const noexcept {
+			return { m_queue.Size(), m_queue.Capacity(),
+				m_producerWaits.load(std::memory_order_relaxed), m_consumerWaits.load(std::memory_order_relaxed) };
+		}
+
+		// every stage before this one, the first one first
+		inline const std::vector<std::shared_ptr<const PipelineStage>>& Upstream() const noexcept {
+			return m_upstream;
+		}
+	};
+
+	// runs the upstream iterator on a thread of its own that is started by the first Next(), the thread is
+	// stopped and joined when the last copy of the iterator goes away, even if not all items were read
+	template<class Iter>
+	class PrefetchState : public PipelineStage
+	{
+		using Item = Option<typename Iter::Type>;
+
+		Iter m_iter;
+		SpscRing<Item> m_ring;
+		Parker m_notEmpty, m_notFull;
+		std::atomic<bool> m_done{ false }, m_stop{ false };
+		std::thread m_thread;
+
+		inline void Produce() {
+			while (!m_stop.load(std::memory_order_relaxed)) {
+				Item v = m_iter.Next();
+				if (!v)
+					break;
+				if (!m_ring.TryPush(v)) {
+					m_producerWaits.fetch_add(1, std::memory_order_relaxed);
+					m_notFull.Wait([this] { return m_ring.Size() < m_ring.Capacity() || m_stop.load(); });
+					if (m_stop.load())
+						break;
+					m_ring.TryPush(v);
+				}
+				m_notEmpty.Notify();
+			}
+			m_done.store(true, std::memory_order_release);
+			m_notEmpty.Notify();
+		}
+
+	public:
+		inline PrefetchState(Iter it, size_t n, std::vector<std::shared_ptr<const PipelineStage>> upstream)
+			: PipelineStage(m_ring, std::move(upstream)), m_iter(std::move(it)), m_ring(std::max(n, size_t(1))) { }
+
+		PrefetchState(const PrefetchState&) = delete;
+		PrefetchState& operator=(const PrefetchState&) = delete;
+
+		inline ~PrefetchState() {
+			if (!m_thread.joinable())
+				return;
+			m_stop.store(true);
+			m_notFull.Notify();
+			m_thread.join();
+		}
+
+		// the upstream bounds until the thread starts, then only the items that are ready
+		inline SizeBounds SizeHint() const noexcept {
+			if (!m_thread.joinable())
+				return m_iter.SizeHint();
+			return { m_ring.Size(), {} };
+		}
+
+		inline Item Next() {
+			if (!m_thread.joinable())
+				m_thread = std::thread([this] { Produce(); });
+			Item v;
+			while (!m_ring.TryPop(v)) {
+				// the last items are pushed before m_done is set
+				if (m_done.load(std::memory_order_acquire)) {
+					if (m_ring.TryPop(v))
+						break;
+					return {};
+				}
+				m_consumerWaits.fetch_add(1, std::memory_order_relaxed);
+				m_notEmpty.Wait([this] { return m_ring.Size() != 0 || m_done.load(); });
+			}
+			m_notFull.Notify();
+			return v;
+		}
+	};
+
+	// copies of the iterator share the producer thread, so the items should be consumed through one of them
+	template<class Iter>
+	struct PrefetchIterTrait
+	{
+		std::shared_ptr<PrefetchState<Iter>> state;
+		using Type = typename Iter::Type;
+		static inline constexpr bool FastCount = false;
+
+		inline SizeBounds SizeHint() const noexcept {
+			return state->SizeHint();
+		}
+
+		inline Option<Type> Next() {
+			return state->Next();
+		}
+	};
+
+	template<class Trait>
+	struct IsPrefetchTrait : std::false_type {};
+
+	template<class Iter>
+	struct IsPrefetchTrait<PrefetchIterTrait<Iter>> : std::true_type {};
+
+	template<class Trait, class = void>
+	struct HasUpstreamIter : std::false_type {};
+
+	template<class Trait>
+	struct HasUpstreamIter<Trait, std::void_t<decltype(std::declval<const Trait&>().iter.GetTrait())>> : std::true_type {};
+
+	// the stages of the pipeline ending in it, found by following the adapters that have one upstream iterator
+	// back to the last Stage() or Prefetch() in the chain
+	template<class Iter>
+	inline std::vector<std::shared_ptr<const PipelineStage>> PipelineStagesOf(const Iter& it) {
+		const auto& trait = it.GetTrait();
+		using Trait = std::decay_t<decltype(trait)>;
+		if constexpr (IsPrefetchTrait<Trait>::value) {
+			auto stages = trait.state->Upstream();
+			stages.push_back(trait.state);
+			return stages;
+		}
+		else if constexpr (HasUpstreamIter<Trait>::value) {
+			return PipelineStagesOf(trait.iter);
+		}
+		else {
+			return {};
+		}
+	}
+
+	// queue occupancy of every Stage() and Prefetch() boundary in the pipeline, the first stage first
+	template<class Iter>
+	inline std::vector<StageStats> Stages(const Iter& it) {
+		std::vector<StageStats> stats;
+		for (const auto& stage : PipelineStagesOf(it))
+			stats.push_back(stage->Stats());
+		return stats;
+	}
+
+	template<class Iter>
+	inline auto PrefetchImpl(Iter it, size_t n) {
+		// collected before the thread that runs it exists
+		auto upstream = PipelineStagesOf(it);
+		auto state = std::make_shared<PrefetchState<Iter>>(std::move(it), n, std::move(upstream));
+		return SDIterator(PrefetchIterTrait<Iter>{ std::move(state) });
+	}
+
+	template<class SDTrait>
+	inline auto SDIterator<SDTrait>::Prefetch(size_t n) const {
+		return PrefetchImpl(*this, n);
+	}
+
+	template<class DDTrait>
+	inline auto DDIterator<DDTrait>::Prefetch(size_t n) const {
+		return PrefetchImpl(*this, n);
+	}
+
+	template<class SDTrait>
+	inline auto SDIterator<SDTrait>::Stage(size_t n) const {
+		return PrefetchImpl(*this, n);
+	}
+
+	template<class DDTrait>
+	inline auto DDIterator<DDTrait>::Stage(size_t n) const {
+		return PrefetchImpl(*this, n);
+	}
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "SDIterator.h"
+#include "DDIterator.h"
+
+namespace Iter
+{
+	enum class Rolling { Sum, Mean, Min, Max };
+
+	// aggregate of every w consecutive items, one per window like Windows(w),
+	// Sum and Mean keep a running total and the last w items in a ring, Mean totals in 64 bits or double
+	// so that narrow items don't wrap,
+	// Min and Max keep a monotonic deque in a ring of w (index, item) pairs whose front is the result,
+	// each item costs O(1) amortized and nothing is allocated after construction
+	template<class Iter, Rolling op>
+	struct RollingIterTrait
+	{
+		using Item = ValueOf<typename Iter::Type>;
+		static inline constexpr bool Extreme = op == Rolling::Min || op == Rolling::Max;
+		using Type = std::conditional_t<op == Rolling::Mean && !std::is_floating_point_v<Item>, double, Item>;
+		using Total = std::conditional_t<op != Rolling::Mean, Item,
+			std::conditional_t<std::is_integral_v<Item>, std::conditional_t<std::is_signed_v<Item>, int64_t, uint64_t>,
+			std::conditional_t<std::is_same_v<Item, float>, double, Item>>>;
+		static inline constexpr bool FastCount = Iter::FastCount;
+
+		Iter iter;
+		size_t w;
+		// number of items read so far
+		size_t seen = 0;
+		// Sum and Mean: the last w items, the oldest one at seen % w
+		std::vector<Item> ring;
+		Total total{};
+		// Min and Max: deque of items that may still become the result, increasing for Min, decreasing for Max
+		std::vector<std::pair<size_t, Item>> deque;
+		size_t head = 0, len = 0;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			if (w == 0)
+				return SizeBounds::Exact(0);
+			return iter.SizeHint().Windows(w - std::min(seen, w - 1));
+		}
+
+		inline RollingIterTrait(Iter i, size_t w) : iter(std::move(i)), w(w) {
+			if constexpr (Extreme) {
+				deque.resize(w);
+			}
+			else {
+				ring.resize(w);
+			}
+		}
+
+		inline Option<Type> Next() {
+			if (w == 0)
+				return {};
+			do {
+				auto v = iter.Next();
+				if (!v)
+					return {};
+				Push(std::forward<typename Iter::Type>(*v));
+			} while (seen < w);
+			if constexpr (Extreme) {
+				return deque[head].second;
+			}
+			else if constexpr (op == Rolling::Mean) {
+				using Div = std::conditional_t<std::is_floating_point_v<Total>, Total, double>;
+				return Type(Div(total) / Div(w));
+			}
+			else {
+				return total;
+			}
+		}
+
+	private:
+		inline void Push(Item v) {
+			if constexpr (Extreme) {
+				auto replaces = [](const Item& back, const Item& v) {
+					if constexpr (op == Rolling::Min) {
+						return !(back < v);
+					}
+					else {
+						return !(v < back);
+					}
+				};
+				// drop the items the new one makes irrelevant from the back, the expired one from the front
+				while (len != 0 && replaces(deque[(head + len - 1) % w].second, v))
+					--len;
+				if (len != 0 && deque[head].first + w <= seen) {
+					head = (head + 1) % w;
+					--len;
+				}
+				deque[(head + len) % w] = { seen, std::move(v) };
+				++len;
+			}
+			else {
+				size_t pos = seen % w;
+				total += v;
+				if (seen >= w)
+					total -= ring[pos];
+				ring[pos] = std::move(v);
+			}
+			++seen;
+		}
+	};
+
+	template<Rolling op, class Iter>
+	inline auto RollingImpl(Iter it, size_t w) {
+		return SDIterator(RollingIterTrait<Iter, op>(std::move(it), w));
+	}
+
+	template<class SDTrait>
+	inline auto SDIterator<SDTrait>::RollingSum(size_t w) const {
+		return RollingImpl<Rolling::Sum>(*this, w);
+	}
+
+	template<class SDTrait>
+	inline auto SDIterator<SDTrait>::RollingMean(size_t w) const {
+		return RollingImpl<Rolling::Mean>(*this, w);
+	}
+
+	template<class SDTrait>
+	inline auto SDIterator<SDTrait>::RollingMin(size_t w) const {
+		return RollingImpl<Rolling::Min>(*this, w);
+	}
+
+	template<class SDTrait>
+	inline auto SDIterator<SDTrait>::RollingMax(size_t w) const {
+		return RollingImpl<Rolling::Max>(*this, w);
+	}
+
+	template<class DDTrait>
+	inline auto DDIterator<DDTrait>::RollingSum(size_t w) const {
+		return RollingImpl<Rolling::Sum>(*this, w);
+	}
+
+	template<class DDTrait>
+	inline auto DDIterator<DDTrait>::RollingMean(size_t w) const {
+		return RollingImpl<Rolling::Mean>(*this, w);
+	}
+
+	template<class DDTrait>
+	inline auto DDIterator<DDTrait>::RollingMin(size_t w) const {
+		return RollingImpl<Rolling::Min>(*this, w);
+	}
+
+	template<class DDTrait>
+	inline auto DDIterator<DDTrait>::RollingMax(size_t w) const {
+		return RollingImpl<Rolling::Max>(*this, w);
+	}
+}
@@ -9,14 +9,39 @@ namespace Iter
 	 *     // type of the item
 	 *     using Type = ...;
 	 * 
-	 *     // true if Count() works
+	 *     // true if SizeHint() is always exact
 	 *     static inline constexpr bool FastCount = ...;
 	 * 
-	 *     // return length of the iterator with O(1) complexity if possible
-	 *     size_t Count()             { ... }
+	 *     // return bounds of the remaining length with O(1) complexity
+	 *     SizeBounds SizeHint()      { ... }
 	 * 
-	 *     // return front and move forward
-	 *     std::optional<Type> Next() { ... }
+	 *     // return front and move forward, Type may be a reference to pass items on without copying
+	 *     Option<Type> Next() { ... }
+	 *
+	 *     // optional: skip up to n items with O(1) complexity, return number of skipped items
+	 *     size_t Advance(size_t n)   { ... }
+	 *
+	 *     // optional: view of the remaining items if they are stored contiguously in memory
+	 *     Slice<const Type> AsSlice() { ... }
+	 *
+	 *     // optional: the remaining items as an arithmetic progression, lets Sum, Min, Max and Product skip iterating
+	 *     Progression<Type> AsProgression() { ... }
+	 *
+	 *     // optional: write up to n items to out, return the number of written items,
+	 *     // less than n only if the iterator was exhausted
+	 *     size_t NextBatch(ValueOf<Type>* out, size_t n) { ... }
+	 *
+	 *     // optional: keep the first n items, return the rest as a separate trait
+	 *     SDTrait SplitAt(size_t n) { ... }
+	 *
+	 *     // optional: keep the front part, return the back part as an independent trait,
+	 *     // nullopt if the remaining items can't be split any further
+	 *     std::optional<SDTrait> Split() { ... }
+	 *
+	 *     // optional: call func(acc, item) for each item until it returns false,
+	 *     // return true if the iterator was exhausted
+	 *     template<class Acc, class Func>
+	 *     bool TryFold(Acc& acc, Func&& func) { ... }
 	 * };
 	*/
 	template<class SDTrait>
@@ -26,25 +51,105 @@ namespace Iter
 	public:
 		using Type = typename SDTrait::Type;
 		static inline constexpr bool FastCount = SDTrait::FastCount;
+		static inline constexpr bool FastAdvance = HasAdvance<SDTrait>::value;
+		static inline constexpr bool FastSplit = HasSplit<SDTrait>::value;
+		static inline constexpr bool FastBatch = HasNextBatch<SDTrait>::value;
 
-		inline constexpr SDIterator(SDTrait t) noexcept : m_trait(t) { }
+		inline constexpr SDIterator(SDTrait t) noexcept : m_trait(std::move(t)) { }
 
-		inline constexpr std::optional<Type> Next() noexcept {
+		inline constexpr Option<Type> Next() noexcept {
 			return m_trait.Next();
 		}
 
-		inline auto begin() const noexcept {
+		// write up to n items to out, return the number of written items, less than n only if the iterator was exhausted
+		inline constexpr size_t NextBatch(ValueOf<Type>* out, size_t n) {
+			if constexpr (HasNextBatch<SDTrait>::value) {
+				return m_trait.NextBatch(out, n);
+			}
+			size_t i = 0;
+			if (n == 0)
+				return i;
+			TryFold(i, [out, n](size_t& i, auto&& v) {
+				out[i++] = std::forward<decltype(v)>(v);
+				return i < n;
+			});
+			return i;
+		}
+
+		inline constexpr size_t Advance(size_t n) noexcept {
+			if constexpr (HasAdvance<SDTrait>::value) {
+				return m_trait.Advance(n);
+			}
+			size_t i = 0;
+			while (i < n && m_trait.Next())
+				++i;
+			return i;
+		}
+
+		// call func(acc, item) for each item until it returns false, return true if all items were visited
+		template<class Acc, class Func>
+		inline constexpr bool TryFold(Acc& acc, Func&& func) noexcept {
+			if constexpr (HasTryFold<SDTrait>::value) {
+				return m_trait.TryFold(acc, func);
+			}
+			while (auto v = m_trait.Next()) {
+				if (!func(acc, std::forward<Type>(*v)))
+					return false;
+			}
+			return true;
+		}
+
+		// state of the adapter, lets Map, Filter and Take look into their upstream to fuse with it
+		inline constexpr const SDTrait& GetTrait() const noexcept {
+			return m_trait;
+		}
+
+		template<class U = SDTrait, std::enable_if_t<HasAsSlice<U>::value, int> = 0>
+		inline constexpr auto AsSlice() const noexcept {
+			return m_trait.AsSlice();
+		}
+
+		template<class U = SDTrait, std::enable_if_t<HasAsProgression<U>::value, int> = 0>
+		inline constexpr auto AsProgression() const noexcept {
+			return m_trait.AsProgression();
+		}
+
+		// cut off the back part into an independent iterator, nullopt if it can't be split any further
+		template<class U = SDTrait, std::enable_if_t<HasSplit<U>::value, int> = 0>
+		inline constexpr std::optional<SDIterator> Split() {
+			if (auto rest = m_trait.Split())
+				return SDIterator(*rest);
+			return {};
+		}
+
+		// keep the first n items, return an iterator over the rest
+		template<class U = SDTrait, std::enable_if_t<HasSplitAt<U>::value, int> = 0>
+		inline constexpr SDIterator SplitAt(size_t n) {
+			return SDIterator(m_trait.SplitAt(n));
+		}
+
+		inline constexpr auto begin() const noexcept {
 			return RangeForIter<SDIterator<SDTrait>>(*this);
 		}
 
-		inline auto end() const noexcept {
-			return RangeForIter<SDIterator<SDTrait>>(*this, false);
+		inline constexpr RangeForEnd end() const noexcept {
+			return {};
 		}
 
 		inline constexpr auto Skip(size_t n) const noexcept;
 		inline constexpr auto Take(size_t n) const noexcept;
 		inline constexpr auto StepBy(size_t n) const noexcept;
-		inline constexpr std::optional<Type> Nth(size_t n) const noexcept;
+
+		// Slice views of n items at a time, the last one may be shorter, n = 0 is taken as 1, see SDChunksIterTrait
+		inline constexpr auto Chunks(size_t n) const;
+
+		// same as Chunks, the items at the end that don't fill a whole chunk are dropped
+		inline constexpr auto ChunksExact(size_t n) const;
+
+		// Slice views of every n consecutive items, see SDWindowsIterTrait
+		inline constexpr auto Windows(size_t n) const;
+
+		inline constexpr Option<Type> Nth(size_t n) const noexcept;
 
 		template<class Iter>
 		inline constexpr auto Zip(Iter other) const noexcept;
@@ -56,9 +161,10 @@ namespace Iter
 		template<class Func, class Ret>
 		inline constexpr Ret Fold(Ret init, Func func) const noexcept {
 			auto it = *this;
-			while (auto v = it.Next()) {
-				init = func(init, v.value());
-			}
+			it.TryFold(init, [&func](Ret& acc, auto&& v) {
+				acc = func(std::move(acc), std::forward<decltype(v)>(v));
+				return true;
+			});
 			return init;
 		}
 
@@ -66,16 +172,33 @@ namespace Iter
 		inline constexpr auto Fold(Func func) const noexcept {
 			auto it = *this;
 			auto init = it.Next().value();
-			while (auto v = it.Next()) {
-				init = func(init, v.value());
-			}
+			it.TryFold(init, [&func](auto& acc, auto&& v) {
+				acc = func(std::move(acc), std::forward<decltype(v)>(v));
+				return true;
+			});
 			return init;
 		}
 
+		template<class Func>
+		inline constexpr void ForEach(Func func) const noexcept {
+			auto it = *this;
+			bool dummy = true;
+			it.TryFold(dummy, [&func](bool&, auto&& v) {
+				func(std::forward<decltype(v)>(v));
+				return true;
+			});
+		}
+
+		inline constexpr SizeBounds SizeHint() const noexcept {
+			return m_trait.SizeHint();
+		}
+
 		inline constexpr size_t Count() const noexcept {
 			if constexpr (SDTrait::FastCount) {
-				return m_trait.Count();
+				return m_trait.SizeHint().lower;
 			}
+			if (auto hint = m_trait.SizeHint(); hint.IsExact())
+				return hint.lower;
 			return Fold(size_t(0),
 				[](auto a, auto) {
 					return a + 1;
@@ -84,35 +207,163 @@ namespace Iter
 		}
 
 		inline constexpr auto Sum() const noexcept {
+			if constexpr (HasAsProgression<SDTrait>::value) {
+				return m_trait.AsProgression().Sum();
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Sum> && HasAsSlice<SDTrait>::value) {
+				auto slice = m_trait.AsSlice();
+				return Simd::Reduce<Simd::Reduction::Sum>(slice.data(), slice.size(), Type(0));
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Sum> && HasNextBatch<SDTrait>::value) {
+				return BatchReduceImpl<Simd::Reduction::Sum>(*this).value_or(Type(0));
+			}
 			return Fold([](auto a, auto b) { return a + b; });
 		}
 
 		inline constexpr auto Product() const noexcept {
+			if constexpr (HasAsProgression<SDTrait>::value) {
+				if (auto res = m_trait.AsProgression().Product())
+					return *res;
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Product> && HasAsSlice<SDTrait>::value) {
+				auto slice = m_trait.AsSlice();
+				return Simd::Reduce<Simd::Reduction::Product>(slice.data(), slice.size(), Type(1));
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Product> && HasNextBatch<SDTrait>::value) {
+				return BatchReduceImpl<Simd::Reduction::Product>(*this).value_or(Type(1));
+			}
 			return Fold([](auto a, auto b) { return a * b; });
 		}
 
+		inline constexpr Option<Type> Min() const noexcept {
+			if constexpr (HasAsProgression<SDTrait>::value) {
+				auto prog = m_trait.AsProgression();
+				if (prog.count == 0)
+					return {};
+				return prog.Min();
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Min> && HasAsSlice<SDTrait>::value) {
+				auto slice = m_trait.AsSlice();
+				if (slice.empty())
+					return {};
+				return Simd::Reduce<Simd::Reduction::Min>(slice.data(), slice.size(), slice[0]);
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Min> && HasNextBatch<SDTrait>::value) {
+				return BatchReduceImpl<Simd::Reduction::Min>(*this);
+			}
+			auto it = *this;
+			auto res = it.Next();
+			if (res) {
+				it.TryFold(res, [](Option<Type>& acc, auto&& v) {
+					if (v < *acc)
+						acc.emplace(std::forward<decltype(v)>(v));
+					return true;
+				});
+			}
+			return res;
+		}
+
+		inline constexpr Option<Type> Max() const noexcept {
+			if constexpr (HasAsProgression<SDTrait>::value) {
+				auto prog = m_trait.AsProgression();
+				if (prog.count == 0)
+					return {};
+				return prog.Max();
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Max> && HasAsSlice<SDTrait>::value) {
+				auto slice = m_trait.AsSlice();
+				if (slice.empty())
+					return {};
+				return Simd::Reduce<Simd::Reduction::Max>(slice.data(), slice.size(), slice[0]);
+			}
+			if constexpr (Simd::IsSupported<Type, Simd::Reduction::Max> && HasNextBatch<SDTrait>::value) {
+				return BatchReduceImpl<Simd::Reduction::Max>(*this);
+			}
+			auto it = *this;
+			auto res = it.Next();
+			if (res) {
+				it.TryFold(res, [](Option<Type>& acc, auto&& v) {
+					if (*acc < v)
+						acc.emplace(std::forward<decltype(v)>(v));
+					return true;
+				});
+			}
+			return res;
+		}
+
 		template<class Func>
 		inline constexpr auto Map(Func func) const noexcept;
 
+		// parallel view, see ParIterator
+		inline auto Par(size_t minChunk = 1) const noexcept;
+
+		// parallel view for sources that can only be read in order, see ParBridge
+		inline auto ParBridge(size_t batch = 1024) const noexcept;
+
+		// aggregates of every w consecutive items, single pass with O(1) per item, see RollingIterTrait
+		inline auto RollingSum(size_t w) const;
+		inline auto RollingMean(size_t w) const;
+		inline auto RollingMin(size_t w) const;
+		inline auto RollingMax(size_t w) const;
+
+		// run this iterator on a background thread that stays up to n items ahead, see PrefetchState
+		inline auto Prefetch(size_t n = 1024) const;
+		// end a pipeline stage: the adapters since the previous Stage() run on a thread of their own,
+		// connected to the next stage by a queue of n items, see Stages()
+		inline auto Stage(size_t n = 1024) const;
+
 		template<class Func>
 		inline constexpr auto Filter(Func func) const noexcept;
 
 		template<class Cont>
 		inline constexpr auto Collect() const noexcept {
-			auto it = *this;
 			Cont cont{};
-			while (auto v = it.Next()) {
-				cont.push_back(v.value());
-			}
+			CollectImpl(*this, cont);
+			return cont;
+		}
+
+		template<class Cont>
+		inline auto Collect(const typename Cont::allocator_type& alloc) const noexcept {
+			Cont cont(alloc);
+			CollectImpl(*this, cont);
 			return cont;
 		}
 
+		// write up to size items to data, return number of written items
+		template<class Out>
+		inline constexpr size_t CollectInto(Out* data, size_t size) const noexcept {
+			return CollectIntoImpl(*this, data, size);
+		}
+
+		// write items to an array, vector, span etc. without resizing it
+		template<class Out>
+		inline constexpr size_t CollectInto(Out&& out) const noexcept {
+			return CollectIntoImpl(*this, std::data(out), std::size(out));
+		}
+
+		// return first N items, empty if there are less than N
+		template<size_t N>
+		inline constexpr std::optional<std::array<ValueOf<Type>, N>> ToArray() const noexcept {
+			std::array<ValueOf<Type>, N> arr{};
+			if (CollectInto(arr) < N)
+				return {};
+			return arr;
+		}
+
 		inline constexpr auto ToVector() const noexcept {
-			return Collect<std::vector<Type>>();
+			return Collect<std::vector<ValueOf<Type>>>();
+		}
+
+		inline auto ToVector(std::pmr::memory_resource* resource) const noexcept {
+			return Collect<std::pmr::vector<ValueOf<Type>>>(resource);
 		}
 
 		inline constexpr auto ToList() const noexcept {
-			return Collect<std::list<Type>>();
+			return Collect<std::list<ValueOf<Type>>>();
+		}
+
+		inline auto ToList(std::pmr::memory_resource* resource) const noexcept {
+			return Collect<std::pmr::list<ValueOf<Type>>>(resource);
 		}
 	};
 
@@ -123,18 +374,64 @@ namespace Iter
 		using Type = T;
 		static inline constexpr bool FastCount = true;
 
-		constexpr inline size_t Count() const noexcept {
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return SizeBounds::Exact(Length());
+		}
+
+		constexpr inline size_t Length() const noexcept {
 			return size_t(end) - size_t(begin);
 		}
 
 		constexpr inline ForwardRangeIterTrait(T b, T e)
 			: begin(b), end(e) { }
 
-		constexpr inline std::optional<T> Next() {
+		constexpr inline Progression<T> AsProgression() const noexcept {
+			return { begin, 1, Length() };
+		}
+
+		constexpr inline Option<T> Next() {
 			if (begin == end)
 				return {};
 			return begin++;
 		}
+
+		constexpr inline size_t NextBatch(T* out, size_t n) noexcept {
+			n = std::min(n, Length());
+			for (size_t i = 0; i < n; ++i)
+				out[i] = T(begin + T(i));
+			begin += T(n);
+			return n;
+		}
+
+		constexpr inline size_t Advance(size_t n) noexcept {
+			n = std::min(n, Length());
+			begin += T(n);
+			return n;
+		}
+
+		// keep the first n items, return the rest
+		constexpr inline ForwardRangeIterTrait SplitAt(size_t n) noexcept {
+			n = std::min(n, Length());
+			auto rest = *this;
+			rest.begin = T(begin + T(n));
+			end = rest.begin;
+			return rest;
+		}
+
+		constexpr inline std::optional<ForwardRangeIterTrait> Split() noexcept {
+			if (Length() < 2)
+				return {};
+			return SplitAt(Length() / 2);
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			while (begin != end) {
+				if (!func(acc, begin++))
+					return false;
+			}
+			return true;
+		}
 	};
 
 	template<class T1, class T2>
@@ -151,14 +448,15 @@ namespace Iter
 	}
 
 	template<class SDTrait>
-	inline constexpr std::optional<typename SDIterator<SDTrait>::Type> SDIterator<SDTrait>::Nth(size_t n) const noexcept {
+	inline constexpr Option<typename SDIterator<SDTrait>::Type> SDIterator<SDTrait>::Nth(size_t n) const noexcept {
 		auto it = this->Skip(n);
 		return it.Next();
 	}
 
+	// skipping advances the iterator right away, so Skip(a).Skip(b) never nests
 	template<class Iter>
 	inline constexpr auto SDSkipImpl(Iter it, size_t n) {
-		while (n-- && it.Next());
+		it.Advance(n);
 		return it;
 	}
 
@@ -175,26 +473,67 @@ namespace Iter
 		using Type = typename Iter::Type;
 		static inline constexpr bool FastCount = Iter::FastCount;
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				return std::min(n, iter.Count());
-			}
-			return 0;
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return iter.SizeHint().Min(n);
 		}
 
-		constexpr inline SDTakeIterTrait(Iter i, size_t n) : iter(i), n(n) { }
+		constexpr inline SDTakeIterTrait(Iter i, size_t n) : iter(std::move(i)), n(n) { }
 
-		constexpr inline std::optional<Type> Next() {
+		constexpr inline Option<Type> Next() {
 			if (n == 0)
 				return {};
 			--n;
 			return iter.Next();
 		}
+
+		template<class U = Iter, std::enable_if_t<U::FastAdvance, int> = 0>
+		constexpr inline size_t Advance(size_t k) noexcept {
+			k = iter.Advance(std::min(k, n));
+			n -= k;
+			return k;
+		}
+
+		template<class U = Iter, std::enable_if_t<HasAsSlice<U>::value, int> = 0>
+		constexpr inline auto AsSlice() const noexcept {
+			return iter.AsSlice().First(n);
+		}
+
+		template<class U = Iter, std::enable_if_t<HasAsProgression<U>::value, int> = 0>
+		constexpr inline auto AsProgression() const noexcept {
+			return iter.AsProgression().Take(n);
+		}
+
+		template<class U = Iter, std::enable_if_t<U::FastBatch, int> = 0>
+		constexpr inline size_t NextBatch(ValueOf<Type>* out, size_t k) {
+			k = iter.NextBatch(out, std::min(k, n));
+			n -= k;
+			return k;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			if (n == 0)
+				return true;
+			bool res = true;
+			iter.TryFold(acc, [&](Acc& a, auto&& v) {
+				--n;
+				res = func(a, std::forward<decltype(v)>(v));
+				return res && n != 0;
+			});
+			return res;
+		}
 	};
 
 	template<class Iter>
 	inline constexpr auto SDTakeImpl(Iter it, size_t n) {
-		return SDIterator(SDTakeIterTrait<Iter>{ it, n });
+		return SDIterator(SDTakeIterTrait<Iter>{ std::move(it), n });
+	}
+
+	// Take(a).Take(b) becomes Take(min(a, b))
+	template<class Iter>
+	inline constexpr auto SDTakeImpl(SDIterator<SDTakeIterTrait<Iter>> it, size_t n) {
+		const auto& take = it.GetTrait();
+		return SDTakeImpl(take.iter, std::min(take.n, n));
 	}
 
 	template<class SDTrait>
@@ -211,26 +550,57 @@ namespace Iter
 		using Type = typename Iter::Type;
 		static inline constexpr bool FastCount = Iter::FastCount;
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				auto size = iter.Count();
-				return size / n + size % n;
-			}
-			return 0;
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return iter.SizeHint().Step(n);
 		}
 
-		constexpr inline SDStepByIterTrait(Iter i, size_t n) : iter(i), n(n) { }
+		constexpr inline SDStepByIterTrait(Iter i, size_t n) : iter(std::move(i)), n(n) { }
+
+		template<class U = Iter, std::enable_if_t<HasAsProgression<U>::value, int> = 0>
+		constexpr inline auto AsProgression() const noexcept {
+			return iter.AsProgression().Step(n);
+		}
 
 		constexpr inline auto Next() {
 			auto v = iter.Next();
-			iter = iter.Skip(n - 1);
+			iter.Advance(n - 1);
 			return v;
 		}
+
+		template<class U = Iter, std::enable_if_t<U::FastAdvance, int> = 0>
+		constexpr inline size_t Advance(size_t k) noexcept {
+			size_t steps = k > size_t(-1) / n ? size_t(-1) : k * n;
+			return (iter.Advance(steps) + n - 1) / n;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			if constexpr (Iter::FastAdvance) {
+				while (auto v = iter.Next()) {
+					iter.Advance(n - 1);
+					if (!func(acc, std::forward<Type>(*v)))
+						return false;
+				}
+				return true;
+			}
+			size_t skip = 0;
+			bool res = iter.TryFold(acc, [&](Acc& a, auto&& v) {
+				if (skip != 0) {
+					--skip;
+					return true;
+				}
+				skip = n - 1;
+				return func(a, std::forward<decltype(v)>(v));
+			});
+			if (!res)
+				iter.Advance(skip);
+			return res;
+		}
 	};
 
 	template<class Iter>
 	inline constexpr auto SDStepByImpl(Iter it, size_t n) {
-		return SDIterator(SDStepByIterTrait{ it, n });
+		return SDIterator(SDStepByIterTrait{ std::move(it), n });
 	}
 
 	template<class SDTrait>
@@ -238,6 +608,162 @@ namespace Iter
 		return SDStepByImpl(*this, n);
 	}
 
+	// Slice views of n items at a time, the last one is shorter if the items run out unless Exact is set,
+	// contiguous sources are viewed in place, others are copied into a buffer allocated once,
+	// so a slice is only valid until the iterator moves on
+	template<class Iter, bool Exact>
+	struct SDChunksIterTrait
+	{
+		using Item = ValueOf<typename Iter::Type>;
+		static inline constexpr bool InPlace = HasAsSlice<Iter>::value;
+
+		Iter iter;
+		size_t n;
+		std::vector<Item> buf;
+		using Type = Slice<const Item>;
+		static inline constexpr bool FastCount = Iter::FastCount;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			auto hint = iter.SizeHint();
+			return Exact ? hint.Chunks(n) : hint.Step(n);
+		}
+
+		// no chunk holds more items than the upstream has left
+		inline SDChunksIterTrait(Iter i, size_t n) : iter(std::move(i)), n(n) {
+			if constexpr (!InPlace) {
+				buf.resize(std::min(n, iter.SizeHint().upper.value_or(n)));
+			}
+		}
+
+		inline Option<Type> Next() {
+			if constexpr (InPlace) {
+				auto slice = iter.AsSlice();
+				size_t m = std::min(n, slice.size());
+				if (m == 0 || (Exact && m < n))
+					return {};
+				iter.Advance(m);
+				return slice.First(m);
+			}
+			else {
+				size_t m = iter.NextBatch(buf.data(), buf.size());
+				if (m == 0 || (Exact && m < n))
+					return {};
+				return Type(buf.data(), m);
+			}
+		}
+
+		template<class U = Iter, std::enable_if_t<U::FastAdvance, int> = 0>
+		constexpr inline size_t Advance(size_t k) noexcept {
+			size_t steps = k > size_t(-1) / n ? size_t(-1) : k * n;
+			size_t m = iter.Advance(steps);
+			return Exact ? m / n : (m + n - 1) / n;
+		}
+	};
+
+	template<class Iter>
+	inline constexpr auto SDChunksImpl(Iter it, size_t n) {
+		return SDIterator(SDChunksIterTrait<Iter, false>(std::move(it), std::max(n, size_t(1))));
+	}
+
+	template<class Iter>
+	inline constexpr auto SDChunksExactImpl(Iter it, size_t n) {
+		return SDIterator(SDChunksIterTrait<Iter, true>(std::move(it), std::max(n, size_t(1))));
+	}
+
+	template<class SDTrait>
+	inline constexpr auto SDIterator<SDTrait>::Chunks(size_t n) const {
+		return SDChunksImpl(*this, n);
+	}
+
+	template<class SDTrait>
+	inline constexpr auto SDIterator<SDTrait>::ChunksExact(size_t n) const {
+		return SDChunksExactImpl(*this, n);
+	}
+
+	// Slice views of every n consecutive items, contiguous sources are viewed in place,
+	// others are written twice into a ring buffer of 2n items so that each window is contiguous,
+	// a slice is only valid until the iterator moves on
+	template<class Iter>
+	struct SDWindowsIterTrait
+	{
+		using Item = ValueOf<typename Iter::Type>;
+		static inline constexpr bool InPlace = HasAsSlice<Iter>::value;
+
+		Iter iter;
+		size_t n;
+		std::vector<Item> buf;
+		// items of the first window read so far, start of the window in buf
+		size_t filled = 0, pos = 0;
+		using Type = Slice<const Item>;
+		static inline constexpr bool FastCount = Iter::FastCount;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			if (n == 0)
+				return SizeBounds::Exact(0);
+			auto hint = iter.SizeHint();
+			return filled == n && !InPlace ? hint : hint.Windows(n - filled);
+		}
+
+		// the buffer stays empty if the upstream can't fill a single window
+		inline SDWindowsIterTrait(Iter i, size_t n) : iter(std::move(i)), n(n) {
+			if constexpr (!InPlace) {
+				if (n <= iter.SizeHint().upper.value_or(n))
+					buf.resize(2 * n);
+			}
+		}
+
+		inline Option<Type> Next() {
+			if (n == 0)
+				return {};
+			if constexpr (InPlace) {
+				auto slice = iter.AsSlice();
+				if (slice.size() < n)
+					return {};
+				iter.Advance(1);
+				return slice.First(n);
+			}
+			else {
+				if (buf.empty())
+					return {};
+				if (filled < n) {
+					for (; filled < n; ++filled) {
+						auto v = iter.Next();
+						if (!v)
+							return {};
+						buf[filled] = std::forward<typename Iter::Type>(*v);
+						buf[filled + n] = buf[filled];
+					}
+					return Type(buf.data(), n);
+				}
+				auto v = iter.Next();
+				if (!v)
+					return {};
+				// the oldest item is replaced in both copies, the window starts right after it
+				buf[pos] = std::forward<typename Iter::Type>(*v);
+				buf[pos + n] = buf[pos];
+				pos = pos + 1 == n ? 0 : pos + 1;
+				return Type(buf.data() + pos, n);
+			}
+		}
+
+		template<class U = Iter, std::enable_if_t<HasAsSlice<U>::value, int> = 0>
+		constexpr inline size_t Advance(size_t k) noexcept {
+			k = std::min(k, SizeHint().lower);
+			iter.Advance(k);
+			return k;
+		}
+	};
+
+	template<class Iter>
+	inline constexpr auto SDWindowsImpl(Iter it, size_t n) {
+		return SDIterator(SDWindowsIterTrait<Iter>(std::move(it), n));
+	}
+
+	template<class SDTrait>
+	inline constexpr auto SDIterator<SDTrait>::Windows(size_t n) const {
+		return SDWindowsImpl(*this, n);
+	}
+
 	template<class T1, class T2>
 	struct SDZipIterTrait
 	{
@@ -246,29 +772,77 @@ namespace Iter
 		using Type = std::tuple<typename T1::Type, typename T2::Type>;
 		static inline constexpr bool FastCount = T1::FastCount && T2::FastCount;
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				return std::min(iter1.Count(), iter2.Count());
-			}
-			return 0;
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return iter1.SizeHint().Min(iter2.SizeHint());
 		}
 
-		constexpr inline SDZipIterTrait(SDIterator<T1> l, SDIterator<T2> r) : iter1(l), iter2(r) { }
+		constexpr inline SDZipIterTrait(SDIterator<T1> l, SDIterator<T2> r) : iter1(std::move(l)), iter2(std::move(r)) { }
+
+		template<class U = T1, std::enable_if_t<HasNextBatch<U>::value && HasNextBatch<T2>::value
+			&& std::is_default_constructible_v<typename U::Type> && std::is_default_constructible_v<typename T2::Type>, int> = 0>
+		constexpr inline size_t NextBatch(ValueOf<Type>* out, size_t n) {
+			constexpr size_t batch = BatchSizeOf<typename T1::Type, typename T2::Type>;
+			typename T1::Type buf1[batch];
+			typename T2::Type buf2[batch];
+			size_t k = 0;
+			while (k < n) {
+				size_t want = std::min(n - k, batch);
+				size_t m = std::min(iter1.NextBatch(buf1, want), iter2.NextBatch(buf2, want));
+				for (size_t i = 0; i < m; ++i)
+					out[k + i] = Type(buf1[i], buf2[i]);
+				k += m;
+				if (m < want)
+					break;
+			}
+			return k;
+		}
 
-		constexpr inline std::optional<Type> Next() {
+		constexpr inline Option<Type> Next() {
 			if (auto next1 = iter1.Next()) {
 				if (auto next2 = iter2.Next()) {
-					return std::make_tuple(next1.value(), next2.value());
+					return Type(std::forward<typename T1::Type>(*next1), std::forward<typename T2::Type>(*next2));
 				}
 			}
 
 			return {};
 		}
+
+		template<class U = T1, std::enable_if_t<HasAdvance<U>::value && HasAdvance<T2>::value, int> = 0>
+		constexpr inline size_t Advance(size_t n) noexcept {
+			return std::min(iter1.Advance(n), iter2.Advance(n));
+		}
+
+		template<class U = T1, std::enable_if_t<HasSplitAt<U>::value && HasSplitAt<T2>::value, int> = 0>
+		constexpr inline SDZipIterTrait SplitAt(size_t n) {
+			return { iter1.SplitAt(n), iter2.SplitAt(n) };
+		}
+
+		// both sides are cut at the same position, so the length must be known
+		template<class U = T1, std::enable_if_t<FastCount && HasSplitAt<U>::value && HasSplitAt<T2>::value, int> = 0>
+		constexpr inline std::optional<SDZipIterTrait> Split() {
+			size_t len = SizeHint().lower;
+			if (len < 2)
+				return {};
+			return SplitAt(len / 2);
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			bool res = true;
+			iter1.TryFold(acc, [&](Acc& a, auto&& v1) {
+				auto v2 = iter2.Next();
+				if (!v2)
+					return false;
+				res = func(a, Type(std::forward<decltype(v1)>(v1), std::forward<typename T2::Type>(*v2)));
+				return res;
+			});
+			return res;
+		}
 	};
 
 	template<class T1, class T2>
 	inline constexpr auto SDZipImpl(SDIterator<T1> l, SDIterator<T2> r) {
-		return SDIterator(SDZipIterTrait{ l, r });
+		return SDIterator(SDZipIterTrait{ std::move(l), std::move(r) });
 	}
 
 	template<class SDTrait>
@@ -283,34 +857,102 @@ namespace Iter
 		static_assert(std::is_same<typename T1::Type, typename T2::Type>::value, "Chained iterators must have same value type");
 		SDIterator<T1> iter1;
 		SDIterator<T2> iter2;
+		// false once the iterator is exhausted or was given to the other half by Split()
+		bool has1 = true;
+		bool has2 = true;
 		using Type = typename T1::Type;
 		static inline constexpr bool FastCount = T1::FastCount && T2::FastCount;
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				return iter1.Count() + iter2.Count();
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			auto res = SizeBounds::Exact(0);
+			if (has1)
+				res = res.Add(iter1.SizeHint());
+			if (has2)
+				res = res.Add(iter2.SizeHint());
+			return res;
+		}
+
+		constexpr inline SDChainIterTrait(SDIterator<T1> l, SDIterator<T2> r) : iter1(std::move(l)), iter2(std::move(r)) { }
+
+		template<class U = T1, std::enable_if_t<HasNextBatch<U>::value && HasNextBatch<T2>::value, int> = 0>
+		constexpr inline size_t NextBatch(ValueOf<Type>* out, size_t n) {
+			size_t k = 0;
+			if (has1) {
+				k = iter1.NextBatch(out, n);
+				if (k == n)
+					return k;
+				has1 = false;
 			}
-			return 0;
+			if (has2)
+				k += iter2.NextBatch(out + k, n - k);
+			return k;
 		}
 
-		constexpr inline SDChainIterTrait(SDIterator<T1> l, SDIterator<T2> r) : iter1(l), iter2(r) { }
+		constexpr inline Option<Type> Next() {
+			if (has1) {
+				if (auto next = iter1.Next()) {
+					return next;
+				}
+				has1 = false;
+			}
 
-		constexpr inline std::optional<Type> Next() {
-			if (auto next = iter1.Next()) {
-				return next.value();
+			if (has2) {
+				return iter2.Next();
 			}
 
-			if (auto next = iter2.Next()) {
-				return next.value();
+			return {};
+		}
+
+		template<class U = T1, std::enable_if_t<HasAdvance<U>::value && HasAdvance<T2>::value, int> = 0>
+		constexpr inline size_t Advance(size_t n) noexcept {
+			size_t k = has1 ? iter1.Advance(n) : 0;
+			if (k < n && has2)
+				k += iter2.Advance(n - k);
+			return k;
+		}
+
+		template<class Acc, class Func>
+		constexpr inline bool TryFold(Acc& acc, Func&& func) {
+			if (has1) {
+				if (!iter1.TryFold(acc, func))
+					return false;
+				has1 = false;
 			}
+			return !has2 || iter2.TryFold(acc, func);
+		}
 
+		// split at the border of the two iterators first, then inside the remaining one
+		template<class U = T1, std::enable_if_t<HasSplit<U>::value && HasSplit<T2>::value, int> = 0>
+		constexpr inline std::optional<SDChainIterTrait> Split() {
+			if (has1 && has2) {
+				auto rest = *this;
+				rest.has1 = false;
+				has2 = false;
+				return rest;
+			}
+			if (has1) {
+				auto half = iter1.Split();
+				if (!half)
+					return {};
+				SDChainIterTrait rest(*half, iter2);
+				rest.has2 = false;
+				return rest;
+			}
+			if (has2) {
+				auto half = iter2.Split();
+				if (!half)
+					return {};
+				SDChainIterTrait rest(iter1, *half);
+				rest.has1 = false;
+				return rest;
+			}
 			return {};
 		}
 	};
 
 	template<class T1, class T2>
 	inline constexpr auto SDChainImpl(SDIterator<T1> l, SDIterator<T2> r) {
-		return SDIterator(SDChainIterTrait{ l, r });
+		return SDIterator(SDChainIterTrait{ std::move(l), std::move(r) });
 	}
 
 	template<class SDTrait>
@@ -327,26 +969,76 @@ namespace Iter
 		using Type = Ret;
 		static inline constexpr bool FastCount = T::FastCount;
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				return iter.Count();
-			}
-			return 0;
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return iter.SizeHint();
 		}
 
-		constexpr inline SDMapIterTrait(SDIterator<T> it, Func f) : iter(it), func(f) { }
+		constexpr inline SDMapIterTrait(SDIterator<T> it, Func f) : iter(std::move(it)), func(std::move(f)) { }
 
-		constexpr inline std::optional<Ret> Next() {
+		constexpr inline Option<Ret> Next() {
 			if (auto next = iter.Next()) {
-				return func(next.value());
+				return func(std::forward<typename T::Type>(*next));
+			}
+			return {};
+		}
+
+		// map whole blocks of the inner items
+		template<class U = T, std::enable_if_t<HasNextBatch<U>::value && std::is_default_constructible_v<typename U::Type>, int> = 0>
+		constexpr inline size_t NextBatch(ValueOf<Ret>* out, size_t n) {
+			constexpr size_t batch = BatchSizeOf<typename T::Type>;
+			typename T::Type buf[batch];
+			size_t k = 0;
+			while (k < n) {
+				size_t want = std::min(n - k, batch);
+				size_t m = iter.NextBatch(buf, want);
+				for (size_t i = 0; i < m; ++i)
+					out[k + i] = func(std::move(buf[i]));
+				k += m;
+				if (m < want)
+					break;
 			}
+			return k;
+		}
+
+		// skipped items are not passed to func
+		template<class U = T, std::enable_if_t<HasAdvance<U>::value, int> = 0>
+		constexpr inline size_t Advance(size_t n) noexcept {
+			return iter.Advance(n);
+		}
+
+		template<class U = T, std::enable_if_t<HasSplitAt<U>::value, int> = 0>
+		constexpr inline SDMapIterTrait SplitAt(size_t n) {
+			return { iter.SplitAt(n), func };
+		}
+
+		template<class U = T, std::enable_if_t<HasSplit<U>::value, int> = 0>
+		constexpr inline std::optional<SDMapIterTrait> Split() {
+			if (auto rest = iter.Split())
+				return SDMapIterTrait{ *rest, func };
 			return {};
 		}
+
+		template<class Acc, class Fold>
+		constexpr inline bool TryFold(Acc& acc, Fold&& fold) {
+			return iter.TryFold(acc, [&](Acc& a, auto&& v) {
+				return fold(a, func(std::forward<decltype(v)>(v)));
+			});
+		}
 	};
 
 	template<class T, class Func>
 	inline constexpr auto SDMapImpl(SDIterator<T> it, Func f) {
-		return SDIterator(SDMapIterTrait<T, Func, decltype(f(it.Next().value()))>{ it, f });
+		return SDIterator(SDMapIterTrait<T, Func, decltype(f(it.Next().value()))>{ std::move(it), std::move(f) });
+	}
+
+	// Map(f).Map(g) becomes Map(g(f(x)))
+	template<class T, class F, class Ret, class Func>
+	inline constexpr auto SDMapImpl(SDIterator<SDMapIterTrait<T, F, Ret>> it, Func g) {
+		const auto& map = it.GetTrait();
+		auto fused = [f = map.func, g = std::move(g)](auto&& v) mutable -> decltype(auto) {
+			return g(f(std::forward<decltype(v)>(v)));
+		};
+		return SDMapImpl(map.iter, std::move(fused));
 	}
 
 	template<class SDTrait>
@@ -361,30 +1053,83 @@ namespace Iter
 		SDIterator<T> iter;
 		Func func;
 		using Type = typename T::Type;
-		static inline constexpr bool FastCount = T::FastCount;
+		static inline constexpr bool FastCount = false;
+
+		constexpr inline SizeBounds SizeHint() const noexcept {
+			return { 0, iter.SizeHint().upper };
+		}
 
-		constexpr inline size_t Count() const noexcept {
-			if constexpr (FastCount) {
-				return iter.Count();
+		constexpr inline SDFilterIterTrait(SDIterator<T> it, Func f) : iter(std::move(it)), func(std::move(f)) { }
+
+		// fill out with inner items and move the matching ones to its front,
+		// arithmetic items are tested a block at a time and compacted without branches
+		template<class U = T, std::enable_if_t<HasNextBatch<U>::value, int> = 0>
+		constexpr inline size_t NextBatch(ValueOf<Type>* out, size_t n) {
+			size_t k = 0;
+			while (k < n) {
+				if constexpr (std::is_arithmetic_v<Type>) {
+					uint8_t keep[BatchSize];
+					size_t want = std::min(n - k, BatchSize);
+					size_t got = iter.NextBatch(out + k, want);
+					for (size_t i = 0; i < got; ++i)
+						keep[i] = bool(func(out[k + i]));
+					k += Simd::Compact(out + k, keep, got);
+					if (got < want)
+						break;
+				} else {
+					size_t end = k + iter.NextBatch(out + k, n - k);
+					for (size_t i = k; i < end; ++i) {
+						if (func(out[i])) {
+							if (k != i)
+								out[k] = std::move(out[i]);
+							++k;
+						}
+					}
+					if (end < n)
+						break;
+				}
 			}
-			return 0;
+			return k;
 		}
 
-		constexpr inline SDFilterIterTrait(SDIterator<T> it, Func f) : iter(it), func(f) { }
+		// the halves are cut by position, not by the number of matching items
+		template<class U = T, std::enable_if_t<HasSplit<U>::value, int> = 0>
+		constexpr inline std::optional<SDFilterIterTrait> Split() {
+			if (auto rest = iter.Split())
+				return SDFilterIterTrait{ *rest, func };
+			return {};
+		}
 
-		constexpr inline std::optional<Type> Next() {
+		constexpr inline Option<Type> Next() {
 			while (auto next = iter.Next()) {
 				if (!func(next.value()))
 					continue;
-				return next.value();
+				return next;
 			}
 			return {};
 		}
+
+		template<class Acc, class Fold>
+		constexpr inline bool TryFold(Acc& acc, Fold&& fold) {
+			return iter.TryFold(acc, [&](Acc& a, auto&& v) {
+				return !func(v) || fold(a, std::forward<decltype(v)>(v));
+			});
+		}
 	};
 
 	template<class T, class Func>
 	inline constexpr auto SDFilterImpl(SDIterator<T> it, Func f) {
-		return SDIterator(SDFilterIterTrait<T, Func>{ it, f });
+		return SDIterator(SDFilterIterTrait<T, Func>{ std::move(it), std::move(f) });
+	}
+
+	// Filter(p).Filter(q) becomes Filter(p(x) && q(x))
+	template<class T, class F, class Func>
+	inline constexpr auto SDFilterImpl(SDIterator<SDFilterIterTrait<T, F>> it, Func q) {
+		const auto& filter = it.GetTrait();
+		auto fused = [p = filter.func, q = std::move(q)](auto& v) mutable {
+			return bool(p(v)) && bool(q(v));
+		};
+		return SDFilterImpl(filter.iter, std::move(fused));
 	}
 
 	template<class SDTrait>
@@ -0,0 +1,613 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ITER_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define ITER_SIMD_TARGET(isa)
+#else
+#define ITER_SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace Iter::Simd
+{
+	enum class Isa { Scalar, Sse2, Avx2, Avx512 };
+
+	enum class Reduction { Sum, Product, Min, Max };
+
+	inline Isa DetectIsa() noexcept {
+#if defined(ITER_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+		__cpuid(info, 1);
+		bool sse2 = info[3] & (1 << 26);
+		bool avx = (info[2] & (1 << 28)) && (info[2] & (1 << 27));
+		uint64_t xcr0 = avx ? _xgetbv(0) : 0;
+		bool avx2 = false, avx512 = false;
+		if (maxLeaf >= 7) {
+			__cpuidex(info, 7, 0);
+			avx2 = info[1] & (1 << 5);
+			avx512 = (info[1] & (1 << 16)) && (info[1] & (1 << 17));
+		}
+		if (avx512 && (xcr0 & 0xE6) == 0xE6)
+			return Isa::Avx512;
+		if (avx2 && (xcr0 & 0x6) == 0x6)
+			return Isa::Avx2;
+		return sse2 ? Isa::Sse2 : Isa::Scalar;
+#elif defined(ITER_SIMD_X86)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+			return Isa::Avx512;
+		if (__builtin_cpu_supports("avx2"))
+			return Isa::Avx2;
+		if (__builtin_cpu_supports("sse2"))
+			return Isa::Sse2;
+		return Isa::Scalar;
+#else
+		return Isa::Scalar;
+#endif
+	}
+
+	inline Isa CurrentIsa() noexcept {
+		static const Isa isa = DetectIsa();
+		return isa;
+	}
+
+	// lane type the kernels use for T, void if T has no kernels
+	template<class T>
+	using LaneType = std::conditional_t<std::is_same_v<T, float> || std::is_same_v<T, double>, T,
+		std::conditional_t<!std::is_integral_v<T> || std::is_same_v<T, bool>, void,
+		std::conditional_t<sizeof(T) == 4, int32_t,
+		std::conditional_t<sizeof(T) == 8, int64_t, void>>>>;
+
+	// min and max of unsigned integers differ from the signed lanes
+	template<class T, Reduction op>
+	inline constexpr bool IsSupported = !std::is_void_v<LaneType<T>>
+		&& (op == Reduction::Sum || op == Reduction::Product || !std::is_unsigned_v<T>);
+
+	template<Reduction op, class T>
+	inline constexpr T ApplyScalar(T a, T b) noexcept {
+		if constexpr (op == Reduction::Min) {
+			return b < a ? b : a;
+		}
+		else if constexpr (op == Reduction::Max) {
+			return a < b ? b : a;
+		}
+		else if constexpr (std::is_integral_v<T>) {
+			// wrap around on overflow like the vector lanes do
+			using U = std::make_unsigned_t<T>;
+			return op == Reduction::Sum ? T(U(a) + U(b)) : T(U(a) * U(b));
+		}
+		else {
+			return op == Reduction::Sum ? a + b : a * b;
+		}
+	}
+
+	template<Reduction op, class T>
+	inline T ReduceScalar(const T* data, size_t size, T identity) noexcept {
+		for (size_t i = 0; i < size; ++i)
+			identity = ApplyScalar<op>(identity, data[i]);
+		return identity;
+	}
+
+#ifdef ITER_SIMD_X86
+	template<class Lane>
+	struct Sse2Ops;
+
+	template<>
+	struct Sse2Ops<float>
+	{
+		using Vec = __m128;
+		static inline constexpr size_t Lanes = 4;
+
+		template<Reduction>
+		static inline constexpr bool Has = true;
+
+		ITER_SIMD_TARGET("sse2") static inline Vec Load(const void* p) { return _mm_loadu_ps((const float*)p); }
+		ITER_SIMD_TARGET("sse2") static inline void Store(void* p, Vec v) { _mm_storeu_ps((float*)p, v); }
+
+		template<Reduction op>
+		ITER_SIMD_TARGET("sse2") static inline Vec Apply(Vec a, Vec b) {
+			if constexpr (op == Reduction::Sum) return _mm_add_ps(a, b);
+			else if constexpr (op == Reduction::Product) return _mm_mul_ps(a, b);
+			else if constexpr (op == Reduction::Min) return _mm_min_ps(a, b);
+			else return _mm_max_ps(a, b);
+		}
+	};
+
+	template<>
+	struct Sse2Ops<double>
+	{
+		using Vec = __m128d;
+		static inline constexpr size_t Lanes = 2;
+
+		template<Reduction>
+		static inline constexpr bool Has = true;
+
+		ITER_SIMD_TARGET("sse2") static inline Vec Load(const void* p) { return _mm_loadu_pd((const double*)p); }
+		ITER_SIMD_TARGET("sse2") static inline void Store(void* p, Vec v) { _mm_storeu_pd((double*)p, v); }
+
+		template<Reduction op>
+		ITER_SIMD_TARGET("sse2") static inline Vec Apply(Vec a, Vec b) {
+			if constexpr (op == Reduction::Sum) return _mm_add_pd(a, b);
+			else if constexpr (op == Reduction::Product) return _mm_mul_pd(a, b);
+			else if constexpr (op == Reduction::Min) return _mm_min_pd(a, b);
+			else return _mm_max_pd(a, b);
+		}
+	};
+
+	template<>
+	struct Sse2Ops<int32_t>
+	{
+		using Vec = __m128i;
+		static inline constexpr size_t Lanes = 4;
+
+		// 32-bit multiplication needs SSE4.1
+		template<Reduction op>
+		static inline constexpr bool Has = op != Reduction::Product;
+
+		ITER_SIMD_TARGET("sse2") static inline Vec Load(const void* p) { return _mm_loadu_si128((const __m128i*)p); }
+		ITER_SIMD_TARGET("sse2") static inline void Store(void* p, Vec v) { _mm_storeu_si128((__m128i*)p, v); }
+
+		template<Reduction op>
+		ITER_SIMD_TARGET("sse2") static inline Vec Apply(Vec a, Vec b) {
+			if constexpr (op == Reduction::Sum) {
+				return _mm_add_epi32(a, b);
+			}
+			else {
+				Vec gt = _mm_cmpgt_epi32(a, b);
+				Vec lo = _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+				Vec hi = _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+				return op == Reduction::Min ? lo : hi;
+			}
+		}
+	};
+
+	template<>
+	struct Sse2Ops<int64_t>
+	{
+		using Vec = __m128i;
+		static inline constexpr size_t Lanes = 2;
+
+		template<Reduction op>
+		static inline constexpr bool Has = op == Reduction::Sum;
+
+		ITER_SIMD_TARGET("sse2") static inline Vec Load(const void* p) { return _mm_loadu_si128((const __m128i*)p); }
+		ITER_SIMD_TARGET("sse2") static inline void Store(void* p, Vec v) { _mm_storeu_si128((__m128i*)p, v); }
+
+		template<Reduction>
+		ITER_SIMD_TARGET("sse2") static inline Vec Apply(Vec a, Vec b) { return _mm_add_epi64(a, b); }
+	};
+
+	template<class Lane>
+	struct Avx2Ops;
+
+	template<>
+	struct Avx2Ops<float>
+	{
+		using Vec = __m256;
+		static inline constexpr size_t Lanes = 8;
+
+		template<Reduction>
+		static inline constexpr bool Has = true;
+
+		ITER_SIMD_TARGET("avx2") static inline Vec Load(const void* p) { return _mm256_loadu_ps((const float*)p); }
+		ITER_SIMD_TARGET("avx2") static inline void Store(void* p, Vec v) { _mm256_storeu_ps((float*)p, v); }
+
+		template<Reduction op>
+		ITER_SIMD_TARGET("avx2") static inline Vec Apply(Vec a, Vec b) {
+			if constexpr (op == Reduction::Sum) return _mm256_add_ps(a, b);
+			else if constexpr (op == Reduction::Product) return _mm256_mul_ps(a, b);
+			else if constexpr (op == Reduction::Min) return _mm256_min_ps(a, b);
+			else return _mm256_max_ps(a, b);
+		}
+	};
+
+	template<>
+	struct Avx2Ops<double>
+	{
+		using Vec = __m256d;
+		static inline constexpr size_t Lanes = 4;
+
+		template<Reduction>
+		static inline constexpr bool Has = true;
+
+		ITER_SIMD_TARGET("avx2") static inline Vec Load(const void* p) { return _mm256_loadu_pd((const double*)p); }
+		ITER_SIMD_TARGET("avx2") static inline void Store(void* p, Vec v) { _mm256_storeu_pd((double*)p, v); }
+
+		template<Reduction op>
+		ITER_SIMD_TARGET("avx2") static inline Vec Apply(Vec a, Vec b) {
+			if constexpr (op == Reduction::Sum) return _mm256_add_pd(a, b);
+			else if constexpr (op == Reduction::Product) return _mm256_mul_pd(a, b);
+			else if constexpr (op == Reduction::Min) return _mm256_min_pd(a, b);
+			else return _mm256_max_pd(a, b);
+		}
+	};
+
+	template<>
+	struct Avx2Ops<int32_t>
+	{
+		using Vec = __m256i;
+		static inline constexpr size_t Lanes = 8;
+
+		template<Reduction>
+		static inline constexpr bool Has = true;
+
+		ITER_SIMD_TARGET("avx2") static inline Vec Load(const void* p) { return _mm256_loadu_si256((const __m256i*)p); }
+		ITER_SIMD_TARGET("avx2") static inline void Store(void* p, Vec v) { _mm256_storeu_si256((__m256i*)p, v); }
+
+		template<Reduction op>
+		ITER_SIMD_TARGET("avx2") static inline Vec Apply(Vec a, Vec b) {
+			if constexpr (op == Reduction::Sum) return _mm256_add_epi32(a, b);
+			else if constexpr (op == Reduction::Product) return _mm256_mullo_epi32(a, b);
+			else if constexpr (op == Reduction::Min) return _mm256_min_epi32(a, b);
+			else return _mm256_max_epi32(a, b);
+		}
+	};
+
+	template<>
+	struct Avx2Ops<int64_t>
+	{
+		using Vec = __m256i;
+		static inline constexpr size_t Lanes = 4;
+
+		// 64-bit multiplication needs AVX-512DQ
+		template<Reduction op>
+		static inline constexpr bool Has = op != Reduction::Product;
+
+		ITER_SIMD_TARGET("avx2") static inline Vec Load(const void* p) { return _mm256_loadu_si256((const __m256i*)p); }
+		ITER_SIMD_TARGET("avx2") static inline void Store(void* p, Vec v) { _mm256_storeu_si256((__m256i*)p, v); }
+
+		template<Reduction op>
+		ITER_SIMD_TARGET("avx2") static inline Vec Apply(Vec a, Vec b) {
+			if constexpr (op == Reduction::Sum) {
+				return _mm256_add_epi64(a, b);
+			}
+			else {
+				Vec gt = _mm256_cmpgt_epi64(a, b);
+				return op == Reduction::Min ? _mm256_blendv_epi8(a, b, gt) : _mm256_blendv_epi8(b, a, gt);
+			}
+		}
+	};
+
+	template<class Lane>
+	struct Avx512Ops;
+
+	template<>
+	struct Avx512Ops<float>
+	{
+		using Vec = __m512;
+		static inline constexpr size_t Lanes = 16;
+
+		template<Reduction>
+		static inline constexpr bool Has = true;
+
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline Vec Load(const void* p) { return _mm512_loadu_ps(p); }
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline void Store(void* p, Vec v) { _mm512_storeu_ps(p, v); }
+
+		template<Reduction op>
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline Vec Apply(Vec a, Vec b) {
+			if constexpr (op == Reduction::Sum) return _mm512_add_ps(a, b);
+			else if constexpr (op == Reduction::Product) return _mm512_mul_ps(a, b);
+			else if constexpr (op == Reduction::Min) return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(b, a, _CMP_LT_OQ), a, b);
+			else return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ), a, b);
+		}
+	};
+
+	template<>
+	struct Avx512Ops<double>
+	{
+		using Vec = __m512d;
+		static inline constexpr size_t Lanes = 8;
+
+		template<Reduction>
+		static inline constexpr bool Has = true;
+
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline Vec Load(const void* p) { return _mm512_loadu_pd(p); }
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline void Store(void* p, Vec v) { _mm512_storeu_pd(p, v); }
+
+		template<Reduction op>
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline Vec Apply(Vec a, Vec b) {
+			if constexpr (op == Reduction::Sum) return _mm512_add_pd(a, b);
+			else if constexpr (op == Reduction::Product) return _mm512_mul_pd(a, b);
+			else if constexpr (op == Reduction::Min) return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(b, a, _CMP_LT_OQ), a, b);
+			else return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, b, _CMP_LT_OQ), a, b);
+		}
+	};
+
+	template<>
+	struct Avx512Ops<int32_t>
+	{
+		using Vec = __m512i;
+		static inline constexpr size_t Lanes = 16;
+
+		template<Reduction>
+		static inline constexpr bool Has = true;
+
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline Vec Load(const void* p) { return _mm512_loadu_si512(p); }
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline void Store(void* p, Vec v) { _mm512_storeu_si512(p, v); }
+
+		template<Reduction op>
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline Vec Apply(Vec a, Vec b) {
+			if constexpr (op == Reduction::Sum) return _mm512_add_epi32(a, b);
+			else if constexpr (op == Reduction::Product) return _mm512_mullo_epi32(a, b);
+			else if constexpr (op == Reduction::Min) return _mm512_mask_blend_epi32(_mm512_cmplt_epi32_mask(b, a), a, b);
+			else return _mm512_mask_blend_epi32(_mm512_cmplt_epi32_mask(a, b), a, b);
+		}
+	};
+
+	template<>
+	struct Avx512Ops<int64_t>
+	{
+		using Vec = __m512i;
+		static inline constexpr size_t Lanes = 8;
+
+		template<Reduction>
+		static inline constexpr bool Has = true;
+
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline Vec Load(const void* p) { return _mm512_loadu_si512(p); }
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline void Store(void* p, Vec v) { _mm512_storeu_si512(p, v); }
+
+		template<Reduction op>
+		ITER_SIMD_TARGET("avx512f,avx512dq") static inline Vec Apply(Vec a, Vec b) {
+			if constexpr (op == Reduction::Sum) return _mm512_add_epi64(a, b);
+			else if constexpr (op == Reduction::Product) return _mm512_mullo_epi64(a, b);
+			else if constexpr (op == Reduction::Min) return _mm512_mask_blend_epi64(_mm512_cmplt_epi64_mask(b, a), a, b);
+			else return _mm512_mask_blend_epi64(_mm512_cmplt_epi64_mask(a, b), a, b);
+		}
+	};
+
+	// the same loop for every instruction set, it has to be stamped out since the target attribute
+	// can't be a template parameter: four independent accumulators, then lanes and tail in scalar code
+#define ITER_SIMD_REDUCE_KERNEL(Name, Target, OpsT)                                       \
+	template<Reduction op, class T>                                                       \
+	ITER_SIMD_TARGET(Target) inline T Name(const T* data, size_t size, T identity) {     \
+		using Ops = OpsT<LaneType<T>>;                                                    \
+		constexpr size_t L = Ops::Lanes;                                                  \
+		size_t i = 0;                                                                     \
+		if (size >= 4 * L) {                                                              \
+			auto acc0 = Ops::Load(data), acc1 = Ops::Load(data + L);                      \
+			auto acc2 = Ops::Load(data + 2 * L), acc3 = Ops::Load(data + 3 * L);          \
+			for (i = 4 * L; i + 4 * L <= size; i += 4 * L) {                              \
+				acc0 = Ops::template Apply<op>(acc0, Ops::Load(data + i));                \
+				acc1 = Ops::template Apply<op>(acc1, Ops::Load(data + i + L));            \
+				acc2 = Ops::template Apply<op>(acc2, Ops::Load(data + i + 2 * L));        \
+				acc3 = Ops::template Apply<op>(acc3, Ops::Load(data + i + 3 * L));        \
+			}                                                                             \
+			acc0 = Ops::template Apply<op>(acc0, acc1);                                   \
+			acc2 = Ops::template Apply<op>(acc2, acc3);                                   \
+			acc0 = Ops::template Apply<op>(acc0, acc2);                                   \
+			for (; i + L <= size; i += L)                                                 \
+				acc0 = Ops::template Apply<op>(acc0, Ops::Load(data + i));                \
+			T lanes[L];                                                                   \
+			Ops::Store(lanes, acc0);                                                      \
+			for (size_t k = 0; k < L; ++k)                                                \
+				identity = ApplyScalar<op>(identity, lanes[k]);                           \
+		}                                                                                 \
+		for (; i < size; ++i)                                                             \
+			identity = ApplyScalar<op>(identity, data[i]);                                \
+		return identity;                                                                  \
+	}
+
+	ITER_SIMD_REDUCE_KERNEL(ReduceSse2, "sse2", Sse2Ops)
+	ITER_SIMD_REDUCE_KERNEL(ReduceAvx2, "avx2", Avx2Ops)
+	ITER_SIMD_REDUCE_KERNEL(ReduceAvx512, "avx512f,avx512dq", Avx512Ops)
+
+#undef ITER_SIMD_REDUCE_KERNEL
+#endif
+
+	/*
+	 * Reduce size items starting at data with the widest kernel the CPU supports.
+	 * identity must be neutral for op (0 for Sum, 1 for Product, any item for Min and Max).
+	 * Lanes are combined in a different order than a left fold, so floating point
+	 * sums and products may differ in the last bits, and NaNs propagate like minps/maxps.
+	 */
+	template<Reduction op, class T>
+	inline T Reduce(const T* data, size_t size, T identity) noexcept {
+#ifdef ITER_SIMD_X86
+		if constexpr (IsSupported<T, op>) {
+			using Lane = LaneType<T>;
+			Isa isa = CurrentIsa();
+			if constexpr (Avx512Ops<Lane>::template Has<op>) {
+				if (isa >= Isa::Avx512)
+					return ReduceAvx512<op>(data, size, identity);
+			}
+			if constexpr (Avx2Ops<Lane>::template Has<op>) {
+				if (isa >= Isa::Avx2)
+					return ReduceAvx2<op>(data, size, identity);
+			}
+			if constexpr (Sse2Ops<Lane>::template Has<op>) {
+				if (isa >= Isa::Sse2)
+					return ReduceSse2<op>(data, size, identity);
+			}
+		}
+#endif
+		return ReduceScalar<op>(data, size, identity);
+	}
+
+	// move the items with nonzero keep[i] to the front of data without branching on keep
+	template<class T>
+	inline size_t CompactScalar(T* data, const uint8_t* keep, size_t size) noexcept {
+		size_t k = 0;
+		for (size_t i = 0; i < size; ++i) {
+			data[k] = data[i];
+			k += keep[i] != 0;
+		}
+		return k;
+	}
+
+	// permutations for the AVX2 compaction, byte j of an entry is the source lane of the j-th kept lane
+	struct CompactTable
+	{
+		uint64_t lanes32[256];
+		uint64_t lanes64[16];
+		uint8_t count[256];
+	};
+
+	inline constexpr CompactTable MakeCompactTable() noexcept {
+		CompactTable table{};
+		for (unsigned mask = 0; mask < 256; ++mask) {
+			unsigned k = 0;
+			for (unsigned lane = 0; lane < 8; ++lane) {
+				if (mask & (1u << lane)) {
+					table.lanes32[mask] |= uint64_t(lane) << (8 * k);
+					if (mask < 16) {
+						table.lanes64[mask] |= uint64_t(2 * lane) << (16 * k);
+						table.lanes64[mask] |= uint64_t(2 * lane + 1) << (16 * k + 8);
+					}
+					++k;
+				}
+			}
+			table.count[mask] = uint8_t(k);
+		}
+		return table;
+	}
+
+	inline constexpr CompactTable CompactLut = MakeCompactTable();
+
+#ifdef ITER_SIMD_X86
+	// keep flags of 8 items as the low bits of a mask
+	ITER_SIMD_TARGET("sse2") inline unsigned KeepMask8(const uint8_t* keep) {
+		__m128i flags = _mm_loadl_epi64((const __m128i*)keep);
+		return unsigned(_mm_movemask_epi8(_mm_sub_epi8(_mm_setzero_si128(), flags)));
+	}
+
+	// the vectors are stored whole at data + k with k <= i, so they only overwrite items that were already loaded
+	template<class T>
+	ITER_SIMD_TARGET("avx2") inline size_t CompactAvx2(T* data, const uint8_t* keep, size_t size) {
+		constexpr unsigned L = 32 / sizeof(T);
+		size_t i = 0, k = 0;
+		for (; i + 8 <= size; i += 8) {
+			unsigned mask = KeepMask8(keep + i);
+			for (unsigned part = 0; part < 8; part += L) {
+				unsigned bits = (mask >> part) & ((1u << L) - 1);
+				const uint64_t* lanes = sizeof(T) == 4 ? &CompactLut.lanes32[bits] : &CompactLut.lanes64[bits];
+				__m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)lanes));
+				__m256i v = _mm256_loadu_si256((const __m256i*)(data + i + part));
+				_mm256_storeu_si256((__m256i*)(data + k), _mm256_permutevar8x32_epi32(v, idx));
+				k += CompactLut.count[bits];
+			}
+		}
+		for (; i < size; ++i) {
+			data[k] = data[i];
+			k += keep[i] != 0;
+		}
+		return k;
+	}
+
+	template<class T>
+	ITER_SIMD_TARGET("avx512f") inline size_t CompactAvx512(T* data, const uint8_t* keep, size_t size) {
+		size_t i = 0, k = 0;
+		for (; i + 16 <= size; i += 16) {
+			unsigned lo = KeepMask8(keep + i), hi = KeepMask8(keep + i + 8);
+			if constexpr (sizeof(T) == 4) {
+				__m512i v = _mm512_loadu_si512(data + i);
+				_mm512_storeu_si512(data + k, _mm512_maskz_compress_epi32(__mmask16(lo | (hi << 8)), v));
+				k += CompactLut.count[lo] + CompactLut.count[hi];
+			} else {
+				__m512i v = _mm512_loadu_si512(data + i);
+				_mm512_storeu_si512(data + k, _mm512_maskz_compress_epi64(__mmask8(lo), v));
+				k += CompactLut.count[lo];
+				v = _mm512_loadu_si512(data + i + 8);
+				_mm512_storeu_si512(data + k, _mm512_maskz_compress_epi64(__mmask8(hi), v));
+				k += CompactLut.count[hi];
+			}
+		}
+		for (; i < size; ++i) {
+			data[k] = data[i];
+			k += keep[i] != 0;
+		}
+		return k;
+	}
+#endif
+
+	/*
+	 * Move the items with nonzero keep[i] to the front of data keeping their order, return their number.
+	 * keep must hold only 0 and 1. 4 and 8 byte trivially copyable items are moved as raw lanes
+	 * with AVX-512 compress or an AVX2 permutation table, others with a branch-free scalar loop.
+	 */
+	template<class T>
+	inline size_t Compact(T* data, const uint8_t* keep, size_t size) noexcept {
+#ifdef ITER_SIMD_X86
+		if constexpr (std::is_trivially_copyable_v<T> && (sizeof(T) == 4 || sizeof(T) == 8)) {
+			Isa isa = CurrentIsa();
+			if (isa >= Isa::Avx512)
+				return CompactAvx512(data, keep, size);
+			if (isa >= Isa::Avx2)
+				return CompactAvx2(data, keep, size);
+		}
+#endif
+		return CompactScalar(data, keep, size);
+	}
+
+	// C runtimes already vectorize memchr
+	inline const char* FindByte(const char* data, size_t size, char c) noexcept {
+		return size != 0 ? (const char*)memchr(data, c, size) : nullptr;
+	}
+
+	inline const char* FindLastByteScalar(const char* data, size_t size, char c) noexcept {
+		while (size != 0) {
+			if (data[--size] == c)
+				return data + size;
+		}
+		return nullptr;
+	}
+
+#ifdef ITER_SIMD_X86
+	inline unsigned HighestBit(uint32_t mask) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+		unsigned long index;
+		_BitScanReverse(&index, mask);
+		return unsigned(index);
+#else
+		return 31u - unsigned(__builtin_clz(mask));
+#endif
+	}
+
+	ITER_SIMD_TARGET("sse2") inline const char* FindLastByteSse2(const char* data, size_t size, char c) {
+		__m128i needle = _mm_set1_epi8(c);
+		while (size >= 16) {
+			size -= 16;
+			__m128i v = _mm_loadu_si128((const __m128i*)(data + size));
+			uint32_t mask = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)));
+			if (mask != 0)
+				return data + size + HighestBit(mask);
+		}
+		return FindLastByteScalar(data, size, c);
+	}
+
+	ITER_SIMD_TARGET("avx2") inline const char* FindLastByteAvx2(const char* data, size_t size, char c) {
+		__m256i needle = _mm256_set1_epi8(c);
+		while (size >= 32) {
+			size -= 32;
+			__m256i v = _mm256_loadu_si256((const __m256i*)(data + size));
+			uint32_t mask = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+			if (mask != 0)
+				return data + size + HighestBit(mask);
+		}
+		return FindLastByteScalar(data, size, c);
+	}
+#endif
+
+	// last occurrence of c in the size bytes starting at data, nullptr if there is none
+	inline const char* FindLastByte(const char* data, size_t size, char c) noexcept {
+#ifdef ITER_SIMD_X86
+		Isa isa = CurrentIsa();
+		if (isa >= Isa::Avx2)
+			return FindLastByteAvx2(data, size, c);
+		if (isa >= Isa::Sse2)
+			return FindLastByteSse2(data, size, c);
+#endif
+		return FindLastByteScalar(data, size, c);
+	}
+}